@@ -15,6 +15,11 @@ GLOBAL stackInit
 GLOBAL semLock
 GLOBAL semUnlock
 
+GLOBAL memzero
+
+GLOBAL outb
+GLOBAL inb
+
 EXTERN register_snapshot
 EXTERN register_snapshot_taken
 
@@ -179,3 +184,27 @@ semLock:
 semUnlock:
     mov BYTE [rdi], 0
     ret
+
+; rdi = destination, rsi = length
+memzero:
+	cld
+	xor rax, rax
+	mov rcx, rsi
+	shr rcx, 3
+	rep stosq
+	mov rcx, rsi
+	and rcx, 7
+	rep stosb
+	ret
+
+outb:
+	mov rdx, rdi
+	mov rax, rsi
+	out dx, al
+	ret
+
+inb:
+	mov rdx, rdi
+	xor rax, rax
+	in al, dx
+	ret
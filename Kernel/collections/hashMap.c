@@ -0,0 +1,230 @@
+// This is a personal academic project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+#include "hashMap.h"
+#include "memoryManager.h"
+#include "strings.h"
+#include "lib.h"
+
+#define HASH_MAP_INITIAL_CAPACITY 16
+
+typedef enum {
+    KEY_STRING,
+    KEY_INTEGER
+} key_kind_t;
+
+/* The full hash is kept so probes and rehashing never touch string keys */
+typedef struct hash_entry {
+    uint64_t key;
+    void *value;
+    uint32_t hash;
+    uint32_t used;
+} hash_entry_t;
+
+struct hash_map {
+    hash_entry_t *entries;
+    size_t capacity;
+    size_t size;
+    key_kind_t kind;
+    mem_tag_t tag;
+};
+
+/* FNV-1a */
+static uint32_t hash_string(const char *key) {
+    uint32_t hash = 2166136261u;
+    while (*key != '\0') {
+        hash ^= (uint8_t)*key++;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+static uint32_t hash_integer(uint64_t key) {
+    return (uint32_t)((key * 0x9E3779B97F4A7C15ULL) >> 32);
+}
+
+static bool keys_equal(const hash_map_t *map, const hash_entry_t *entry, uint64_t key, uint32_t hash) {
+    if (entry->hash != hash) {
+        return false;
+    }
+    if (map->kind == KEY_INTEGER) {
+        return entry->key == key;
+    }
+    return strcmp((const char *)(uintptr_t)entry->key, (const char *)(uintptr_t)key) == 0;
+}
+
+static hash_map_t *map_create(key_kind_t kind, mem_tag_t tag) {
+    hash_map_t *map = mem_alloc_tagged(sizeof(hash_map_t), tag);
+    if (map == NULL) {
+        return NULL;
+    }
+    map->entries = NULL;
+    map->capacity = 0;
+    map->size = 0;
+    map->kind = kind;
+    map->tag = tag;
+    return map;
+}
+
+hash_map_t *hash_map_create_str(mem_tag_t tag) {
+    return map_create(KEY_STRING, tag);
+}
+
+hash_map_t *hash_map_create_int(mem_tag_t tag) {
+    return map_create(KEY_INTEGER, tag);
+}
+
+void hash_map_destroy(hash_map_t *map) {
+    if (map == NULL) {
+        return;
+    }
+    mem_free(map->entries);
+    mem_free(map);
+}
+
+size_t hash_map_size(const hash_map_t *map) {
+    return map == NULL ? 0 : map->size;
+}
+
+static size_t find_slot(const hash_map_t *map, uint64_t key, uint32_t hash) {
+    size_t mask = map->capacity - 1;
+    size_t index = hash & mask;
+    while (map->entries[index].used && !keys_equal(map, &map->entries[index], key, hash)) {
+        index = (index + 1) & mask;
+    }
+    return index;
+}
+
+static bool map_grow(hash_map_t *map) {
+    size_t capacity = map->capacity == 0 ? HASH_MAP_INITIAL_CAPACITY : map->capacity * 2;
+    hash_entry_t *entries = mem_alloc_tagged(capacity * sizeof(hash_entry_t), map->tag);
+    if (entries == NULL) {
+        return false;
+    }
+    memzero(entries, capacity * sizeof(hash_entry_t));
+
+    hash_entry_t *old = map->entries;
+    size_t old_capacity = map->capacity;
+    map->entries = entries;
+    map->capacity = capacity;
+
+    for (size_t i = 0; i < old_capacity; i++) {
+        if (old[i].used) {
+            size_t index = old[i].hash & (capacity - 1);
+            while (entries[index].used) {
+                index = (index + 1) & (capacity - 1);
+            }
+            entries[index] = old[i];
+        }
+    }
+    mem_free(old);
+    return true;
+}
+
+static bool map_put(hash_map_t *map, uint64_t key, uint32_t hash, void *value) {
+    /* Kept at most three quarters full so probe chains stay short */
+    if ((map->size + 1) * 4 > map->capacity * 3 && !map_grow(map)) {
+        return false;
+    }
+
+    hash_entry_t *entry = &map->entries[find_slot(map, key, hash)];
+    if (!entry->used) {
+        entry->key = key;
+        entry->hash = hash;
+        entry->used = 1;
+        map->size++;
+    }
+    entry->value = value;
+    return true;
+}
+
+static void *map_get(const hash_map_t *map, uint64_t key, uint32_t hash) {
+    if (map->size == 0) {
+        return NULL;
+    }
+    const hash_entry_t *entry = &map->entries[find_slot(map, key, hash)];
+    return entry->used ? entry->value : NULL;
+}
+
+/* Backward-shift deletion keeps probe chains intact without tombstones */
+static void *map_remove(hash_map_t *map, uint64_t key, uint32_t hash) {
+    if (map->size == 0) {
+        return NULL;
+    }
+
+    size_t mask = map->capacity - 1;
+    size_t hole = find_slot(map, key, hash);
+    if (!map->entries[hole].used) {
+        return NULL;
+    }
+    void *value = map->entries[hole].value;
+
+    size_t next = hole;
+    while (1) {
+        next = (next + 1) & mask;
+        if (!map->entries[next].used) {
+            break;
+        }
+        size_t home = map->entries[next].hash & mask;
+        bool movable = hole <= next ? (home <= hole || home > next) : (home <= hole && home > next);
+        if (movable) {
+            map->entries[hole] = map->entries[next];
+            hole = next;
+        }
+    }
+    map->entries[hole].used = 0;
+    map->size--;
+    return value;
+}
+
+void hash_map_for_each(const hash_map_t *map, hash_map_visit_t visit, void *context) {
+    if (map == NULL || visit == NULL) {
+        return;
+    }
+    for (size_t i = 0; i < map->capacity; i++) {
+        if (map->entries[i].used && !visit(map->entries[i].value, context)) {
+            return;
+        }
+    }
+}
+
+bool hash_map_put_str(hash_map_t *map, const char *key, void *value) {
+    if (map == NULL || map->kind != KEY_STRING || key == NULL) {
+        return false;
+    }
+    return map_put(map, (uint64_t)(uintptr_t)key, hash_string(key), value);
+}
+
+void *hash_map_get_str(const hash_map_t *map, const char *key) {
+    if (map == NULL || map->kind != KEY_STRING || key == NULL) {
+        return NULL;
+    }
+    return map_get(map, (uint64_t)(uintptr_t)key, hash_string(key));
+}
+
+void *hash_map_remove_str(hash_map_t *map, const char *key) {
+    if (map == NULL || map->kind != KEY_STRING || key == NULL) {
+        return NULL;
+    }
+    return map_remove(map, (uint64_t)(uintptr_t)key, hash_string(key));
+}
+
+bool hash_map_put_int(hash_map_t *map, uint64_t key, void *value) {
+    if (map == NULL || map->kind != KEY_INTEGER) {
+        return false;
+    }
+    return map_put(map, key, hash_integer(key), value);
+}
+
+void *hash_map_get_int(const hash_map_t *map, uint64_t key) {
+    if (map == NULL || map->kind != KEY_INTEGER) {
+        return NULL;
+    }
+    return map_get(map, key, hash_integer(key));
+}
+
+void *hash_map_remove_int(hash_map_t *map, uint64_t key) {
+    if (map == NULL || map->kind != KEY_INTEGER) {
+        return NULL;
+    }
+    return map_remove(map, key, hash_integer(key));
+}
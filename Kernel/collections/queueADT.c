@@ -2,6 +2,7 @@
 // PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
 #include "queueADT.h"
 #include "memoryManager.h"
+#include "slab.h"
 
 struct queue_node {
     void *data;
@@ -14,6 +15,19 @@ struct queue {
     size_t size;
 };
 
+static kmem_cache_t *node_cache = NULL;
+
+static struct queue_node *node_alloc(void) {
+    if (node_cache == NULL) {
+        node_cache = kmem_cache_create("queue_node", sizeof(struct queue_node), MEM_TAG_KERNEL);
+    }
+    return kmem_cache_alloc(node_cache);
+}
+
+static void node_free(struct queue_node *node) {
+    kmem_cache_free(node_cache, node);
+}
+
 queue_t *queue_create(void) {
     queue_t *queue = mem_alloc(sizeof(queue_t));
     if (queue == NULL) {
@@ -36,7 +50,7 @@ void queue_clear(queue_t *queue, void (*destroy)(void *element)) {
         if (destroy != NULL) {
             destroy(current->data);
         }
-        mem_free(current);
+        node_free(current);
         current = next;
     }
 
@@ -66,7 +80,7 @@ bool queue_push(queue_t *queue, void *element) {
         return false;
     }
 
-    struct queue_node *node = mem_alloc(sizeof(struct queue_node));
+    struct queue_node *node = node_alloc();
     if (node == NULL) {
         return false;
     }
@@ -104,7 +118,7 @@ bool queue_remove(queue_t *queue, void *element) {
                 queue->tail = prev;
             }
 
-            mem_free(current);
+            node_free(current);
             queue->size--;
             return true;
         }
@@ -128,7 +142,7 @@ void *queue_pop(queue_t *queue) {
         queue->tail = NULL;
     }
 
-    mem_free(node);
+    node_free(node);
     queue->size--;
 
     return data;
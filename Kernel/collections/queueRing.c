@@ -0,0 +1,167 @@
+// This is a personal academic project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+#include "queueADT.h"
+#include "memoryManager.h"
+#include "lib.h"
+
+#define QUEUE_INITIAL_CAPACITY 8
+
+/*
+ * Growable ring buffer of element pointers. capacity is always a power of
+ * two so positions wrap with a mask; the array is only allocated on the
+ * first push, since most child and wait queues stay empty.
+ */
+struct queue {
+    void **items;
+    size_t capacity;
+    size_t head;
+    size_t size;
+};
+
+static size_t slot_of(const queue_t *queue, size_t position) {
+    return (queue->head + position) & (queue->capacity - 1);
+}
+
+/*
+ * Doubles the array with mem_realloc, which can often extend it in place.
+ * Elements that wrapped past the old end are moved after it so the ring
+ * stays contiguous from head.
+ */
+static bool queue_grow(queue_t *queue) {
+    size_t capacity = queue->capacity == 0 ? QUEUE_INITIAL_CAPACITY : queue->capacity * 2;
+    void **items = mem_realloc(queue->items, capacity * sizeof(void *));
+    if (items == NULL) {
+        return false;
+    }
+
+    size_t old_capacity = queue->capacity;
+    if (queue->head + queue->size > old_capacity) {
+        size_t wrapped = queue->head + queue->size - old_capacity;
+        memcpy(items + old_capacity, items, wrapped * sizeof(void *));
+    }
+
+    queue->items = items;
+    queue->capacity = capacity;
+    return true;
+}
+
+queue_t *queue_create(void) {
+    queue_t *queue = mem_alloc(sizeof(queue_t));
+    if (queue == NULL) {
+        return NULL;
+    }
+    queue->items = NULL;
+    queue->capacity = 0;
+    queue->head = 0;
+    queue->size = 0;
+    return queue;
+}
+
+void queue_clear(queue_t *queue, void (*destroy)(void *element)) {
+    if (queue == NULL) {
+        return;
+    }
+
+    if (destroy != NULL) {
+        for (size_t i = 0; i < queue->size; i++) {
+            destroy(queue->items[slot_of(queue, i)]);
+        }
+    }
+
+    queue->head = 0;
+    queue->size = 0;
+}
+
+void queue_destroy(queue_t *queue, void (*destroy)(void *element)) {
+    if (queue == NULL) {
+        return;
+    }
+    queue_clear(queue, destroy);
+    mem_free(queue->items);
+    mem_free(queue);
+}
+
+bool queue_is_empty(const queue_t *queue) {
+    return queue == NULL || queue->size == 0;
+}
+
+size_t queue_size(const queue_t *queue) {
+    return queue == NULL ? 0 : queue->size;
+}
+
+bool queue_push(queue_t *queue, void *element) {
+    if (queue == NULL) {
+        return false;
+    }
+
+    if (queue->size == queue->capacity && !queue_grow(queue)) {
+        return false;
+    }
+
+    queue->items[slot_of(queue, queue->size)] = element;
+    queue->size++;
+    return true;
+}
+
+/* Closes the gap by shifting whichever side of it is shorter */
+bool queue_remove(queue_t *queue, void *element) {
+    if (queue == NULL) {
+        return false;
+    }
+
+    for (size_t i = 0; i < queue->size; i++) {
+        if (queue->items[slot_of(queue, i)] != element) {
+            continue;
+        }
+
+        if (i < queue->size / 2) {
+            for (size_t j = i; j > 0; j--) {
+                queue->items[slot_of(queue, j)] = queue->items[slot_of(queue, j - 1)];
+            }
+            queue->head = slot_of(queue, 1);
+        } else {
+            for (size_t j = i; j + 1 < queue->size; j++) {
+                queue->items[slot_of(queue, j)] = queue->items[slot_of(queue, j + 1)];
+            }
+        }
+        queue->size--;
+        return true;
+    }
+
+    return false;
+}
+
+void *queue_pop(queue_t *queue) {
+    if (queue == NULL || queue->size == 0) {
+        return NULL;
+    }
+
+    void *data = queue->items[queue->head];
+    queue->head = slot_of(queue, 1);
+    queue->size--;
+    return data;
+}
+
+void *queue_peek(const queue_t *queue) {
+    if (queue == NULL || queue->size == 0) {
+        return NULL;
+    }
+    return queue->items[queue->head];
+}
+
+queue_iterator_t queue_iter(const queue_t *queue) {
+    queue_iterator_t iterator = {0};
+    iterator.queue = queue;
+    return iterator;
+}
+
+bool queue_iter_has_next(const queue_iterator_t *iterator) {
+    return iterator != NULL && iterator->queue != NULL && iterator->index < iterator->queue->size;
+}
+
+void *queue_iter_next(queue_iterator_t *iterator) {
+    if (!queue_iter_has_next(iterator)) {
+        return NULL;
+    }
+    return iterator->queue->items[slot_of(iterator->queue, iterator->index++)];
+}
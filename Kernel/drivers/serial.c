@@ -0,0 +1,55 @@
+// This is a personal academic project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+#include <serial.h>
+#include <lib.h>
+
+#define SERIAL_DATA (SERIAL_COM1 + 0)
+#define SERIAL_INTERRUPTS (SERIAL_COM1 + 1)
+#define SERIAL_FIFO (SERIAL_COM1 + 2)
+#define SERIAL_LINE_CONTROL (SERIAL_COM1 + 3)
+#define SERIAL_MODEM_CONTROL (SERIAL_COM1 + 4)
+#define SERIAL_LINE_STATUS (SERIAL_COM1 + 5)
+
+#define LINE_DLAB 0x80
+#define LINE_8N1 0x03
+#define STATUS_TRANSMIT_EMPTY 0x20
+
+static uint8_t serial_ready = 0;
+
+void serial_init(void) {
+    outb(SERIAL_INTERRUPTS, 0x00);
+    outb(SERIAL_LINE_CONTROL, LINE_DLAB);
+    /* Divisor 1: 115200 baud */
+    outb(SERIAL_DATA, 0x01);
+    outb(SERIAL_INTERRUPTS, 0x00);
+    outb(SERIAL_LINE_CONTROL, LINE_8N1);
+    outb(SERIAL_FIFO, 0xC7);
+    outb(SERIAL_MODEM_CONTROL, 0x03);
+    serial_ready = 1;
+}
+
+static void serial_put(char c) {
+    while ((inb(SERIAL_LINE_STATUS) & STATUS_TRANSMIT_EMPTY) == 0) {
+    }
+    outb(SERIAL_DATA, (uint8_t)c);
+}
+
+void serial_write(const char *buffer, uint64_t length) {
+    if (!serial_ready || buffer == NULL) {
+        return;
+    }
+    for (uint64_t i = 0; i < length; i++) {
+        serial_put(buffer[i]);
+    }
+}
+
+void serial_print(const char *string) {
+    if (string == NULL) {
+        return;
+    }
+    uint64_t length = 0;
+    while (string[length] != '\0') {
+        length++;
+    }
+    serial_write(string, length);
+}
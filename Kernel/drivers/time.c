@@ -6,50 +6,47 @@
 #include <cursor.h>
 #include <process.h>
 #include <scheduler.h>
-#include <queueADT.h>
-#include <memoryManager.h>
+#include <waitQueue.h>
 
 static unsigned long ticks = 0;
 
-typedef struct {
-	int32_t pid;
-	unsigned long wake_time;
-} SleepingProcess;
+/*
+ * Armed wake-ups, linked through the PCBs and kept sorted by wake_tick so
+ * each tick only looks at the front. Arming walks the list (at most
+ * PROCESS_MAX_PROCESSES entries); cancelling unlinks in O(1).
+ */
+static process_t *sleepers_head = NULL;
+static process_t *sleepers_tail = NULL;
 
-static queue_t *sleeping_queue = NULL;
+/* Where plain sleeps wait; nobody wakes it, only the timer does */
+static wait_queue_t sleeping_queue;
 
-static void init_sleeping_queue(void) {
-	if (sleeping_queue == NULL) {
-		sleeping_queue = queue_create();
+static void sleepers_unlink(process_t *process) {
+	if (process->sleep_prev != NULL) {
+		process->sleep_prev->sleep_next = process->sleep_next;
+	} else {
+		sleepers_head = process->sleep_next;
 	}
+	if (process->sleep_next != NULL) {
+		process->sleep_next->sleep_prev = process->sleep_prev;
+	} else {
+		sleepers_tail = process->sleep_prev;
+	}
+	process->sleep_prev = NULL;
+	process->sleep_next = NULL;
+	process->sleep_armed = false;
 }
 
 void timer_handler() {
 	ticks++;
+	scheduler_charge_tick();
 	toggleCursor();
 
-	if (sleeping_queue != NULL && !queue_is_empty(sleeping_queue)) {
-		queue_iterator_t iter = queue_iter(sleeping_queue);
-		
-		while (queue_iter_has_next(&iter)) {
-			SleepingProcess *process = (SleepingProcess *)queue_iter_next(&iter);
-			
-			if (process != NULL && process->wake_time <= ticks) {
-				process_t *proc = process_lookup(process->pid);
-				if (proc != NULL) {
-					process_unblock(proc);
-				}
-			}
-		}
-		
-		iter = queue_iter(sleeping_queue);
-		while (queue_iter_has_next(&iter)) {
-			SleepingProcess *process = (SleepingProcess *)queue_iter_next(&iter);
-			if (process != NULL && process->wake_time <= ticks) {
-				queue_remove(sleeping_queue, process);
-				mem_free(process);
-			}
-		}
+	while (sleepers_head != NULL && sleepers_head->wake_tick <= ticks) {
+		process_t *process = sleepers_head;
+		sleepers_unlink(process);
+		wait_queue_timeout(process);
+		process_unblock(process);
 	}
 }
 
@@ -61,30 +58,59 @@ int seconds_elapsed() {
 	return ticks / SECONDS_TO_TICKS;
 }
 
-void sleepTicks(uint64_t sleep_t) {
-	init_sleeping_queue();
-	
-	process_t *current = scheduler_current();
-	if (current == NULL) {
-		return; 
+bool sleep_arm(process_t *process, uint64_t sleep_t) {
+	if (process == NULL) {
+		return false;
+	}
+
+	uint64_t flags = interrupts_save_and_disable();
+	sleep_cancel(process);
+
+	process->wake_tick = ticks + sleep_t;
+	process_t *next = sleepers_head;
+	while (next != NULL && next->wake_tick <= process->wake_tick) {
+		next = next->sleep_next;
 	}
 
-	SleepingProcess *process = (SleepingProcess *)mem_alloc(sizeof(SleepingProcess));
+	process->sleep_next = next;
+	process->sleep_prev = next != NULL ? next->sleep_prev : sleepers_tail;
+	if (process->sleep_prev != NULL) {
+		process->sleep_prev->sleep_next = process;
+	} else {
+		sleepers_head = process;
+	}
+	if (next != NULL) {
+		next->sleep_prev = process;
+	} else {
+		sleepers_tail = process;
+	}
+	process->sleep_armed = true;
+
+	interrupts_restore(flags);
+	return true;
+}
+
+void sleep_cancel(process_t *process) {
 	if (process == NULL) {
 		return;
 	}
 
-	process->pid = current->pid;
-	process->wake_time = ticks + sleep_t;
-	
-	if (!queue_push(sleeping_queue, process)) {
-		mem_free(process);
+	uint64_t flags = interrupts_save_and_disable();
+	if (process->sleep_armed) {
+		sleepers_unlink(process);
+	}
+	interrupts_restore(flags);
+}
+
+void sleepTicks(uint64_t sleep_t) {
+	if (scheduler_current() == NULL) {
 		return;
 	}
 
-	process_block(current);
-	
-	_force_scheduler_interrupt();
+	/* Zero still gives up the CPU until the next tick */
+	uint64_t flags = interrupts_save_and_disable();
+	wait_queue_sleep(&sleeping_queue, sleep_t > 0 ? sleep_t : 1);
+	interrupts_restore(flags);
 }
 
 void sleep(int seconds) {
@@ -7,6 +7,9 @@
 #include <fonts.h>
 #include <interrupts.h>
 
+/* Bytes echoed per round trip through STDOUT/STDERR; at most PIPE_BUFFER_SIZE */
+#define FD_ECHO_CHUNK 256
+
 static int is_valid_fd(int32_t fd) {
     return fd == READ_FD || fd == WRITE_FD || fd == ERROR_FD;
 }
@@ -140,21 +143,26 @@ int write(int32_t fd, const uint8_t *user_buffer, int32_t count) {
     }
 
     int pipe_id = current->fd_targets[fd];
-    int written = write_pipe(pipe_id, user_buffer, (uint64_t)count);
-    if (written < 0) {
-        return written;
-    }
-
-    if ((fd == WRITE_FD && current->fd_targets[WRITE_FD] == STDOUT) ||
-        (fd == ERROR_FD && current->fd_targets[ERROR_FD] == STDERR)) {
-        for (int i = 0; i < written; i++) {
-            uint8_t c;
-            if (read_pipe(pipe_id, &c, 1) == -1) {
-                return -1;
-            }
-            const char out_char = (char)c;
-            printToFd(pipe_id, &out_char, 1);
+    int echoes = (fd == WRITE_FD && pipe_id == STDOUT) || (fd == ERROR_FD && pipe_id == STDERR);
+    if (!echoes) {
+        return write_pipe(pipe_id, user_buffer, (uint64_t)count);
+    }
+
+    /* The terminal pipes are drained right here, a chunk at a time so they never fill up */
+    uint8_t chunk[FD_ECHO_CHUNK];
+    int written = 0;
+    while (written < count) {
+        int len = count - written < FD_ECHO_CHUNK ? count - written : FD_ECHO_CHUNK;
+        int put = write_pipe(pipe_id, user_buffer + written, (uint64_t)len);
+        if (put <= 0) {
+            return written > 0 ? written : -1;
+        }
+        int echoed = read_pipe(pipe_id, chunk, (uint64_t)put);
+        if (echoed < 0) {
+            return -1;
         }
+        printToFd(pipe_id, (const char *)chunk, echoed);
+        written += put;
     }
 
     return written;
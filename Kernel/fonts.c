@@ -187,6 +187,25 @@ void retractPosition() {
     xBufferPosition -= glyphSizeX * fontSize;
 }
 
+void setCursorPosition(uint16_t column, uint16_t row) {
+    hideCursor();
+
+    int32_t x = column * glyphSizeX * fontSize;
+    int32_t y = row * glyphSizeY * fontSize;
+
+    if (x + glyphSizeX * fontSize > getWindowWidth()) {
+        x = 0;
+    }
+    if (y + glyphSizeY * fontSize > getWindowHeight()) {
+        y = getWindowHeight() - (getWindowHeight() % (glyphSizeY * fontSize)) - glyphSizeY * fontSize;
+    }
+
+    xBufferPosition = x;
+    yBufferPosition = y;
+    maxGlyphSizeYOnLine = glyphSizeY * fontSize;
+    dirty_line = 0;
+}
+
 void clearPreviousCharacter(void){
     hideCursor();
     retractPosition();
@@ -0,0 +1,170 @@
+// This is a personal academic project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+#include <futex.h>
+#include <hashMap.h>
+#include <process.h>
+#include <scheduler.h>
+#include <interrupts.h>
+#include <slab.h>
+#include <waitQueue.h>
+
+/*
+ * Wait queues keyed by the address being waited on. A queue only exists
+ * while someone waits, so idle futexes cost nothing. Every access happens
+ * with interrupts disabled, which on this single CPU also makes the value
+ * check in futex_wait atomic with the enqueue. Each process remembers its
+ * key so whoever empties a queue can drop it from the map.
+ */
+static hash_map_t *futex_queues = NULL;
+static kmem_cache_t *futex_cache = NULL;
+
+static wait_queue_t *queue_for(volatile uint32_t *addr, bool create) {
+    if (futex_queues == NULL) {
+        if (!create) {
+            return NULL;
+        }
+        futex_queues = hash_map_create_int(MEM_TAG_SEM);
+        futex_cache = kmem_cache_create("futex", sizeof(wait_queue_t), MEM_TAG_SEM);
+        if (futex_queues == NULL || futex_cache == NULL) {
+            return NULL;
+        }
+    }
+
+    uint64_t key = (uint64_t)(uintptr_t)addr;
+    wait_queue_t *queue = hash_map_get_int(futex_queues, key);
+    if (queue == NULL && create) {
+        queue = kmem_cache_alloc(futex_cache);
+        if (queue == NULL) {
+            return NULL;
+        }
+        wait_queue_init(queue);
+        if (!hash_map_put_int(futex_queues, key, queue)) {
+            kmem_cache_free(futex_cache, queue);
+            return NULL;
+        }
+    }
+    return queue;
+}
+
+static void drop_if_empty(volatile uint32_t *addr, wait_queue_t *queue) {
+    if (queue->count == 0) {
+        hash_map_remove_int(futex_queues, (uint64_t)(uintptr_t)addr);
+        kmem_cache_free(futex_cache, queue);
+    }
+}
+
+/* Drops the queue the process waited on if that left it empty */
+static void forget_key(process_t *process) {
+    volatile uint32_t *addr = process->futex_key;
+    process->futex_key = NULL;
+    wait_queue_t *queue = queue_for(addr, false);
+    if (queue != NULL) {
+        drop_if_empty(addr, queue);
+    }
+}
+
+/* Wakes up to count waiters, oldest first, with result */
+static int32_t wake_waiters(volatile uint32_t *addr, uint32_t count, int32_t result) {
+    wait_queue_t *queue = queue_for(addr, false);
+    if (queue == NULL) {
+        return 0;
+    }
+
+    int32_t woken = wait_queue_wake(queue, count, result);
+    drop_if_empty(addr, queue);
+    return woken;
+}
+
+int32_t futex_wait(volatile uint32_t *addr, uint32_t expected) {
+    return futex_wait_timeout(addr, expected, 0);
+}
+
+int32_t futex_wait_timeout(volatile uint32_t *addr, uint32_t expected, uint64_t timeout_ticks) {
+    return futex_wait_counted(addr, expected, timeout_ticks, NULL);
+}
+
+/* Drops the caller's share of the waiter count it registered, if any */
+static void forget_waiter(process_t *process) {
+    if (process->futex_waiters != NULL) {
+        __sync_fetch_and_sub(process->futex_waiters, 1);
+        process->futex_waiters = NULL;
+    }
+}
+
+int32_t futex_wait_counted(volatile uint32_t *addr, uint32_t expected, uint64_t timeout_ticks, volatile uint32_t *waiters) {
+    process_t *current = scheduler_current();
+    if (addr == NULL || current == NULL) {
+        return -1;
+    }
+
+    uint64_t flags = interrupts_save_and_disable();
+
+    if (*addr != expected) {
+        interrupts_restore(flags);
+        return FUTEX_CHANGED;
+    }
+
+    wait_queue_t *queue = queue_for(addr, true);
+    if (queue == NULL) {
+        interrupts_restore(flags);
+        return -1;
+    }
+
+    current->futex_key = addr;
+    if (waiters != NULL) {
+        __sync_fetch_and_add(waiters, 1);
+        current->futex_waiters = waiters;
+    }
+    int32_t result = wait_queue_sleep(queue, timeout_ticks);
+    if (result == FUTEX_RELEASED) {
+        current->futex_waiters = NULL;
+    }
+    forget_waiter(current);
+    /* Wakers drop the queue they empty; timeouts and spurious wakes leave it to us */
+    forget_key(current);
+    interrupts_restore(flags);
+    return result;
+}
+
+int32_t futex_wake(volatile uint32_t *addr, uint32_t count) {
+    if (addr == NULL) {
+        return -1;
+    }
+
+    uint64_t flags = interrupts_save_and_disable();
+    int32_t woken = wake_waiters(addr, count, FUTEX_WOKEN);
+    interrupts_restore(flags);
+    return woken;
+}
+
+void futex_release(volatile uint32_t *addr) {
+    if (addr == NULL) {
+        return;
+    }
+
+    uint64_t flags = interrupts_save_and_disable();
+    wake_waiters(addr, UINT32_MAX, FUTEX_RELEASED);
+    interrupts_restore(flags);
+}
+
+uint32_t futex_waiters(volatile uint32_t *addr) {
+    uint64_t flags = interrupts_save_and_disable();
+    wait_queue_t *queue = queue_for(addr, false);
+    uint32_t waiters = queue == NULL ? 0 : queue->count;
+    interrupts_restore(flags);
+    return waiters;
+}
+
+void futex_cancel(process_t *process) {
+    if (process == NULL) {
+        return;
+    }
+
+    uint64_t flags = interrupts_save_and_disable();
+    if (process->futex_key != NULL) {
+        wait_queue_cancel(process);
+        forget_waiter(process);
+        forget_key(process);
+    }
+    interrupts_restore(flags);
+}
@@ -13,6 +13,8 @@
 #include <memoryManager.h>
 #include <queueADT.h>
 #include <sem.h>
+#include <futex.h>
+#include <sync.h>
 #include <fd.h>
 #include <pipes.h>
 #include <interrupts.h>
@@ -39,6 +41,7 @@ int64_t syscallDispatcher(Registers * registers) {
 		case 0x80000009: return sys_fonts_set_size((uint8_t) registers->rdi);
 		case 0x8000000A: return sys_clear_screen();
 		case 0x8000000B: return sys_clear_screen_character();
+		case 0x8000000C: return sys_set_cursor_position(registers->rdi, registers->rsi);
 
 		case 0x80000010: return sys_hour((int *) registers->rdi);
 		case 0x80000011: return sys_minute((int *) registers->rdi);
@@ -50,6 +53,16 @@ int64_t syscallDispatcher(Registers * registers) {
 		case 0x80000022: return (int64_t) sys_mem_alloc(registers->rdi);
 		case 0x80000023: return sys_mem_free((void *) registers->rdi);
 		case 0x80000024: return sys_mem_status_print();
+		case 0x80000025: return sys_mem_cache_snapshot((kmem_cache_info_t *) registers->rdi, (uint32_t) registers->rsi);
+		case 0x80000026: return (int64_t) sys_mem_map(registers->rdi);
+		case 0x80000027: return sys_mem_unmap((void *) registers->rdi);
+		case 0x80000028: return sys_mem_profile_control((uint32_t) registers->rdi);
+		case 0x80000029: return sys_mem_profile_snapshot((mem_profile_info_t *) registers->rdi);
+		case 0x8000002A: return sys_mem_trace_control((uint32_t) registers->rdi);
+		case 0x8000002B: return sys_mem_trace_info((mem_trace_info_t *) registers->rdi);
+		case 0x8000002C: return (int64_t) sys_mem_aligned_alloc(registers->rdi, registers->rsi);
+		case 0x8000002D: return (int64_t) sys_mem_calloc(registers->rdi, registers->rsi);
+		case 0x8000002E: return (int64_t) sys_mem_realloc((void *) registers->rdi, registers->rsi);
 
 		case 0x800000A0: return sys_exec((int (*)(void)) registers->rdi);
 
@@ -59,6 +72,7 @@ int64_t syscallDispatcher(Registers * registers) {
 		case 0x800000C1: return sys_window_height();
 
 		case 0x800000D0: return sys_sleep_milis(registers->rdi);
+		case 0x800000D1: return sys_ticks_elapsed();
 
 		case 0x800000E0: return sys_get_register_snapshot((int64_t *) registers->rdi);
 
@@ -67,10 +81,28 @@ int64_t syscallDispatcher(Registers * registers) {
 	case 0x80000122: return sys_sem_wait((sem_t *) registers->rdi);
 	case 0x80000123: return sys_sem_post((sem_t *) registers->rdi);
 	case 0x80000124: return sys_sem_set_value((sem_t *) registers->rdi, (uint32_t)registers->rsi);
+	case 0x80000125: return sys_futex_wait((volatile uint32_t *) registers->rdi, (uint32_t) registers->rsi);
+	case 0x80000126: return sys_futex_wake((volatile uint32_t *) registers->rdi, (uint32_t) registers->rsi);
+	case 0x80000127: return sys_sem_timedwait((sem_t *) registers->rdi, (uint32_t) registers->rsi);
+	case 0x80000128: return sys_sem_snapshot((sem_info_t *) registers->rdi, (uint32_t) registers->rsi);
 
-	case 0x80000130: return sys_open_pipe();
+	case 0x80000130: return sys_open_pipe((uint32_t) registers->rdi);
 	case 0x80000131: return sys_set_fd_targets((uint64_t)registers->rdi, (uint64_t)registers->rsi, (uint64_t)registers->rdx);
 	case 0x80000132: return sys_clear_pipe((uint64_t)registers->rdi);
+	case 0x80000133: return sys_resize_pipe((uint64_t)registers->rdi, (uint32_t)registers->rsi);
+
+	case 0x80000140: return sys_sync_create((sync_type_t) registers->rdi, (uint32_t) registers->rsi);
+	case 0x80000141: return sys_sync_destroy((int32_t) registers->rdi);
+	case 0x80000142: return sys_mutex_lock((int32_t) registers->rdi);
+	case 0x80000143: return sys_mutex_trylock((int32_t) registers->rdi);
+	case 0x80000144: return sys_mutex_unlock((int32_t) registers->rdi);
+	case 0x80000145: return sys_cond_wait((int32_t) registers->rdi, (int32_t) registers->rsi);
+	case 0x80000146: return sys_cond_signal((int32_t) registers->rdi);
+	case 0x80000147: return sys_cond_broadcast((int32_t) registers->rdi);
+	case 0x80000148: return sys_rwlock_read_lock((int32_t) registers->rdi);
+	case 0x80000149: return sys_rwlock_write_lock((int32_t) registers->rdi);
+	case 0x8000014A: return sys_rwlock_unlock((int32_t) registers->rdi);
+	case 0x8000014B: return sys_barrier_wait((int32_t) registers->rdi);
 
 	case 0x80000100: return sys_process_create(
 			(void (*)(int, char **)) registers->rdi,
@@ -91,6 +123,8 @@ int64_t syscallDispatcher(Registers * registers) {
 		case 0x8000010A: return sys_process_wait_children();
 		case 0x8000010B: return sys_process_give_foreground(registers->rdi);
 		case 0x8000010C: return sys_process_get_foreground();
+		case 0x8000010D: return sys_process_snapshot((process_info_t *) registers->rdi, (uint32_t) registers->rsi);
+		case 0x8000010E: return (int64_t) sys_process_self();
 		
 		default:
             return 0;
@@ -154,6 +188,11 @@ int32_t sys_clear_screen_character(void) {
 	return 0;
 }
 
+int32_t sys_set_cursor_position(uint64_t column, uint64_t row) {
+	setCursorPosition((uint16_t) column, (uint16_t) row);
+	return 0;
+}
+
 uint16_t sys_window_width(void) {
 	return getWindowWidth();
 }
@@ -202,18 +241,66 @@ int32_t sys_fill_video_memory(uint32_t hexColor) {
 // Memory management system calls
 // ==================================================================
 void *sys_mem_alloc(uint64_t size) {
-	return mem_alloc((size_t) size);
+	return process_heap_alloc(scheduler_current(), (size_t) size);
 }
 
 int32_t sys_mem_free(void *ptr) {
-	mem_free(ptr);
-	return 0;
+	if (ptr == NULL) {
+		return 0;
+	}
+	return process_heap_free(ptr);
+}
+
+void *sys_mem_map(uint64_t size) {
+	return process_heap_alloc(scheduler_current(), (size_t) size);
+}
+
+int32_t sys_mem_unmap(void *chunk) {
+	return process_heap_free(chunk);
+}
+
+void *sys_mem_aligned_alloc(uint64_t align, uint64_t size) {
+	return process_heap_alloc_aligned(scheduler_current(), (size_t) size, (size_t) align);
+}
+
+void *sys_mem_calloc(uint64_t count, uint64_t size) {
+	if (count == 0 || size == 0 || count > SIZE_MAX / size) {
+		return NULL;
+	}
+	return process_heap_alloc_zeroed(scheduler_current(), (size_t) (count * size));
+}
+
+void *sys_mem_realloc(void *ptr, uint64_t size) {
+	if (ptr == NULL) {
+		return process_heap_alloc(scheduler_current(), (size_t) size);
+	}
+	return process_heap_realloc(ptr, (size_t) size);
 }
 
 int32_t sys_mem_status_print(void) {
 	return print_mem_status();
 }
 
+int32_t sys_mem_cache_snapshot(kmem_cache_info_t *buffer, uint32_t capacity) {
+	return kmem_cache_snapshot(buffer, capacity);
+}
+
+int32_t sys_mem_profile_control(uint32_t command) {
+	return mem_profile_control(command);
+}
+
+int32_t sys_mem_profile_snapshot(mem_profile_info_t *buffer) {
+	return mem_profile_snapshot(buffer);
+}
+
+int64_t sys_mem_trace_control(uint32_t command) {
+	return mem_trace_control(command);
+}
+
+int32_t sys_mem_trace_info(mem_trace_info_t *info) {
+	return mem_trace_get_info(info);
+}
+
 // ==================================================================
 // Semaphore system calls
 // ==================================================================
@@ -237,9 +324,9 @@ int64_t sys_sem_open(const char *name, uint32_t initial_count, uint8_t create_if
 	}
 
 	sem_init(sem, name, initial_count);
-	if (sem->name == NULL || sem->waiting_processes == NULL) {
+	if (sem->name == NULL) {
 		sem_destroy(sem);
-		mem_free(sem);
+		sem_free(sem);
 		return -1;
 	}
 
@@ -252,7 +339,7 @@ int32_t sys_sem_close(sem_t *sem) {
 	}
 
 	sem_destroy(sem);
-	mem_free(sem);
+	sem_free(sem);
 	return 0;
 }
 
@@ -274,6 +361,82 @@ int32_t sys_sem_set_value(sem_t *sem, uint32_t new_value) {
 	return sem_set_value(sem, new_value);
 }
 
+int32_t sys_sem_timedwait(sem_t *sem, uint32_t ms) {
+	if (sem == NULL) {
+		return -1;
+	}
+	return sem_timedwait(sem, ms);
+}
+
+int32_t sys_sem_snapshot(sem_info_t *buffer, uint32_t capacity) {
+	return sem_snapshot(buffer, capacity);
+}
+
+int32_t sys_futex_wait(volatile uint32_t *addr, uint32_t expected) {
+	if (addr == NULL || ((uintptr_t)addr & (sizeof(uint32_t) - 1)) != 0) {
+		return -1;
+	}
+	return futex_wait(addr, expected);
+}
+
+int32_t sys_futex_wake(volatile uint32_t *addr, uint32_t count) {
+	if (addr == NULL || ((uintptr_t)addr & (sizeof(uint32_t) - 1)) != 0) {
+		return -1;
+	}
+	return futex_wake(addr, count);
+}
+
+// ==================================================================
+// Sync object system calls
+// ==================================================================
+int32_t sys_sync_create(sync_type_t type, uint32_t barrier_count) {
+	return sync_create(type, barrier_count);
+}
+
+int32_t sys_sync_destroy(int32_t handle) {
+	return sync_destroy(handle);
+}
+
+int32_t sys_mutex_lock(int32_t handle) {
+	return mutex_lock(handle);
+}
+
+int32_t sys_mutex_trylock(int32_t handle) {
+	return mutex_trylock(handle);
+}
+
+int32_t sys_mutex_unlock(int32_t handle) {
+	return mutex_unlock(handle);
+}
+
+int32_t sys_cond_wait(int32_t cond, int32_t mutex) {
+	return cond_wait(cond, mutex);
+}
+
+int32_t sys_cond_signal(int32_t cond) {
+	return cond_signal(cond);
+}
+
+int32_t sys_cond_broadcast(int32_t cond) {
+	return cond_broadcast(cond);
+}
+
+int32_t sys_rwlock_read_lock(int32_t handle) {
+	return rwlock_read_lock(handle);
+}
+
+int32_t sys_rwlock_write_lock(int32_t handle) {
+	return rwlock_write_lock(handle);
+}
+
+int32_t sys_rwlock_unlock(int32_t handle) {
+	return rwlock_unlock(handle);
+}
+
+int32_t sys_barrier_wait(int32_t handle) {
+	return barrier_wait(handle);
+}
+
 // ==================================================================
 // Exec system call
 // ==================================================================
@@ -314,6 +477,10 @@ int32_t sys_sleep_milis(uint32_t milis) {
 	return 0;
 }
 
+int64_t sys_ticks_elapsed(void) {
+	return ticks_elapsed();
+}
+
 // ==================================================================
 // Register snapshot system calls
 // ==================================================================
@@ -340,6 +507,14 @@ int32_t sys_process_list(void) {
 	return print_process_list();
 }
 
+int32_t sys_process_snapshot(process_info_t *buffer, uint32_t capacity) {
+	return process_snapshot(buffer, capacity);
+}
+
+const process_self_t *sys_process_self(void) {
+	return process_self();
+}
+
 int32_t sys_process_set_priority(uint32_t pid, uint8_t priority) {
 	return scheduler_set_process_priority(pid, priority);
 }
@@ -431,8 +606,8 @@ int32_t sys_process_get_foreground(void) {
 // ==================================================================
 // Pipes and FD target system calls
 // ==================================================================
-int32_t sys_open_pipe(void) {
-    return open_pipe();
+int32_t sys_open_pipe(uint32_t capacity) {
+    return open_pipe(capacity);
 }
 
 int32_t sys_set_fd_targets(uint64_t read_target, uint64_t write_target, uint64_t error_target) {
@@ -443,3 +618,10 @@ int32_t sys_clear_pipe(uint64_t pipe_id) {
     clear_pipe((uint8_t)pipe_id);
     return 0;
 }
+
+int32_t sys_resize_pipe(uint64_t pipe_id, uint32_t capacity) {
+    if (pipe_id >= MAX_PIPES) {
+        return -1;
+    }
+    return resize_pipe((uint8_t)pipe_id, capacity);
+}
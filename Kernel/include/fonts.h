@@ -31,6 +31,7 @@ void hideCursor(void);
 void retractPosition();
 void clearPreviousCharacter(void);
 uint16_t getXBufferPosition(void);
+void setCursorPosition(uint16_t column, uint16_t row);
 
 uint8_t increaseFontSize(void);
 uint8_t decreaseFontSize(void);
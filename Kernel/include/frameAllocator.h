@@ -0,0 +1,27 @@
+#ifndef TP_SO_FRAMEALLOCATOR_H
+#define TP_SO_FRAMEALLOCATOR_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define FRAME_SIZE 4096
+#define FRAME_REGION_MAX 16
+
+/* Pure64 leaves the E820 map at 0x4000 and the RAM size in MiB at 0x5020 */
+#define E820_MAP_ADDRESS 0x4000
+#define E820_TYPE_USABLE 1
+#define MEM_AMOUNT_ADDRESS 0x5020
+
+/* Builds the list of free physical regions from the bootloader's memory map */
+void frames_init(void);
+
+/* Removes [start, end) from the free regions, splitting them as needed */
+void frames_reserve(uint64_t start, uint64_t end);
+
+/* Hands out count contiguous frames for good, NULL if no region has them */
+void *frames_alloc(size_t count);
+
+/* Frames in the longest contiguous run still available */
+size_t frames_largest_run(void);
+
+#endif
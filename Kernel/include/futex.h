@@ -0,0 +1,53 @@
+#ifndef KERNEL_FUTEX_H
+#define KERNEL_FUTEX_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <waitQueue.h>
+
+struct process;
+
+/* futex_wait results; all but FUTEX_CHANGED come straight from the wait queue */
+#define FUTEX_WOKEN WAIT_WOKEN
+#define FUTEX_CHANGED 1
+#define FUTEX_RELEASED WAIT_RELEASED
+#define FUTEX_TIMEDOUT WAIT_TIMEDOUT
+
+/*
+ * Blocks the running process on addr as long as *addr still holds expected,
+ * checked atomically with the enqueue. Returns FUTEX_WOKEN after a wake (or
+ * a spurious unblock; callers re-check their condition), FUTEX_CHANGED when
+ * the value had already moved on, FUTEX_RELEASED when futex_release freed
+ * addr meanwhile (it must not be touched again) and -1 when there is no
+ * running process or the wait queue could not be allocated.
+ */
+int32_t futex_wait(volatile uint32_t *addr, uint32_t expected);
+
+/*
+ * futex_wait that also gives up after timeout_ticks timer ticks (0 waits
+ * forever) with FUTEX_TIMEDOUT. The process sits on the futex queue and
+ * the timer list at once; whichever fires first unlinks the other entry.
+ */
+int32_t futex_wait_timeout(volatile uint32_t *addr, uint32_t expected, uint64_t timeout_ticks);
+
+/*
+ * futex_wait_timeout that counts the caller in *waiters for as long as it
+ * sits on the queue, for callers that only wake when someone waits. The
+ * count is taken atomically with the value check and dropped on every way
+ * out, futex_cancel included, except FUTEX_RELEASED, as that memory is gone.
+ */
+int32_t futex_wait_counted(volatile uint32_t *addr, uint32_t expected, uint64_t timeout_ticks, volatile uint32_t *waiters);
+
+/* Wakes up to count processes waiting on addr; returns how many woke */
+int32_t futex_wake(volatile uint32_t *addr, uint32_t count);
+
+/* Wakes every waiter on addr with FUTEX_RELEASED, for memory about to be freed */
+void futex_release(volatile uint32_t *addr);
+
+/* Number of processes currently queued on addr */
+uint32_t futex_waiters(volatile uint32_t *addr);
+
+/* Drops a process from whatever futex it waits on, e.g. when it is killed */
+void futex_cancel(struct process *process);
+
+#endif
@@ -0,0 +1,38 @@
+#ifndef KERNEL_HASH_MAP_H
+#define KERNEL_HASH_MAP_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <memProfile.h>
+
+/*
+ * Open-addressing hash map from either string or integer keys to pointers.
+ * A map is created for one kind of key and only the matching functions
+ * work on it. String keys are not copied: the caller keeps each key alive
+ * and unchanged while it is in the map.
+ */
+typedef struct hash_map hash_map_t;
+
+/* The table is charged to tag in the allocation profile */
+hash_map_t *hash_map_create_str(mem_tag_t tag);
+hash_map_t *hash_map_create_int(mem_tag_t tag);
+void hash_map_destroy(hash_map_t *map);
+
+size_t hash_map_size(const hash_map_t *map);
+
+/* Inserts or replaces; false only when the table could not grow */
+bool hash_map_put_str(hash_map_t *map, const char *key, void *value);
+void *hash_map_get_str(const hash_map_t *map, const char *key);
+/* Returns the value that was stored under key, or NULL */
+void *hash_map_remove_str(hash_map_t *map, const char *key);
+
+/* Visits every value in table order until visit returns false */
+typedef bool (*hash_map_visit_t)(void *value, void *context);
+void hash_map_for_each(const hash_map_t *map, hash_map_visit_t visit, void *context);
+
+bool hash_map_put_int(hash_map_t *map, uint64_t key, void *value);
+void *hash_map_get_int(const hash_map_t *map, uint64_t key);
+void *hash_map_remove_int(hash_map_t *map, uint64_t key);
+
+#endif
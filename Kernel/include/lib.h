@@ -4,11 +4,14 @@
 #include <stdint.h>
 #include <stddef.h>
 #include <fonts.h>
+#include <memoryManager.h>
 
 #define EOF -1
 
 void * memset(void * destination, int32_t character, uint64_t length);
 void * memcpy(void * destination, const void * source, uint64_t length);
+/* Clears length bytes with string stores; much faster than memset for large buffers */
+void memzero(void * destination, uint64_t length);
 void printf(const char * string);
 uint32_t uint_to_base(uint64_t value, char *buffer, uint32_t base);
 
@@ -24,5 +27,8 @@ uint8_t * stackInit(void * rsp, void * rip, int argc, char ** argv);
 void semLock(uint8_t *lock);
 void semUnlock(uint8_t *lock);
 
-int32_t print_mem_status_common(size_t total, size_t used, size_t available);
+void outb(uint16_t port, uint8_t value);
+uint8_t inb(uint16_t port);
+
+int32_t print_mem_status_common(const mem_stats_t *stats);
 #endif
@@ -0,0 +1,124 @@
+#ifndef TP_SO_MEM_PROFILE_H
+#define TP_SO_MEM_PROFILE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Requested sizes are bucketed by power of two, from <= 8 bytes up to > 512 KiB */
+#define MEM_PROFILE_BUCKETS 18
+#define MEM_PROFILE_TOP_SITES 12
+
+typedef enum mem_tag {
+    MEM_TAG_KERNEL,
+    MEM_TAG_SCHEDULER,
+    MEM_TAG_PROCESS,
+    MEM_TAG_SEM,
+    MEM_TAG_PIPES,
+    MEM_TAG_USER,
+    MEM_TAG_COUNT
+} mem_tag_t;
+
+typedef struct mem_profile_usage {
+    uint64_t live_bytes;
+    uint64_t live_blocks;
+    uint64_t allocations;
+} mem_profile_usage_t;
+
+typedef struct mem_profile_site {
+    uint64_t address;
+    uint32_t tag;
+    uint32_t reserved;
+    mem_profile_usage_t usage;
+} mem_profile_site_t;
+
+/* Flat copy of the profiler state handed to userland */
+typedef struct mem_profile_info {
+    uint8_t enabled;
+    uint32_t site_count;
+    uint64_t ticks;
+    uint64_t allocations;
+    uint64_t frees;
+    /* Frees of blocks allocated while profiling was off, or already freed */
+    uint64_t untracked_frees;
+    /* Allocations that did not fit the tracking table */
+    uint64_t dropped;
+    uint64_t live_bytes;
+    uint64_t peak_bytes;
+    uint64_t histogram[MEM_PROFILE_BUCKETS];
+    mem_profile_usage_t tags[MEM_TAG_COUNT];
+    /* Call sites with the most live bytes, largest first */
+    mem_profile_site_t sites[MEM_PROFILE_TOP_SITES];
+} mem_profile_info_t;
+
+#define MEM_PROFILE_OFF 0
+#define MEM_PROFILE_ON 1
+#define MEM_PROFILE_RESET 2
+
+/*
+ * Checked inline by the allocators, together with mem_trace_active, so
+ * profiling and tracing cost a single branch while both are off. Only
+ * mem_profile_control changes it.
+ */
+extern volatile bool mem_profile_active;
+extern volatile bool mem_trace_active;
+
+void mem_profile_on_alloc(void *ptr, size_t size, void *caller);
+void mem_profile_on_free(void *ptr);
+
+#define MEM_PROFILE_ALLOC(ptr, size) \
+    do { \
+        if ((mem_profile_active || mem_trace_active) && (ptr) != NULL) { \
+            mem_profile_on_alloc((ptr), (size), __builtin_return_address(0)); \
+        } \
+    } while (0)
+
+#define MEM_PROFILE_FREE(ptr) \
+    do { \
+        if (mem_profile_active || mem_trace_active) { \
+            mem_profile_on_free(ptr); \
+        } \
+    } while (0)
+
+/*
+ * Bracket the body of mem_realloc so the block, in place or moved, is
+ * recorded again under the tag and call site it was first allocated with
+ * instead of as a kernel allocation made by the allocator. Both must run
+ * with interrupts disabled.
+ */
+void mem_profile_inherit(void *ptr);
+void mem_profile_inherit_end(void);
+
+#define MEM_PROFILE_REALLOC_BEGIN(ptr) \
+    do { \
+        if (mem_profile_active) { \
+            mem_profile_inherit(ptr); \
+        } \
+    } while (0)
+
+#define MEM_PROFILE_REALLOC_END() \
+    do { \
+        if (mem_profile_active) { \
+            mem_profile_inherit_end(); \
+        } \
+    } while (0)
+
+/* mem_alloc on behalf of a subsystem, attributed to the caller of this function */
+void *mem_alloc_tagged(size_t size, mem_tag_t tag);
+
+/* Same as mem_alloc_tagged for mem_alloc_aligned */
+void *mem_alloc_aligned_tagged(size_t size, size_t align, mem_tag_t tag);
+
+/*
+ * Takes the tracking table from the frame allocator. Called at boot before
+ * mem_init, which hands every remaining frame to the heap; without it
+ * mem_profile_control can never turn profiling on.
+ */
+void mem_profile_init(void);
+
+/* Turns profiling on or off, or clears it; returns 1 if it was on, -1 on failure */
+int32_t mem_profile_control(uint32_t command);
+
+int32_t mem_profile_snapshot(mem_profile_info_t *buffer);
+
+#endif
@@ -0,0 +1,40 @@
+#ifndef TP_SO_MEM_TRACE_H
+#define TP_SO_MEM_TRACE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Ring buffer capacity; the oldest records are overwritten once full */
+#define MEM_TRACE_RECORDS 16384
+
+#define MEM_TRACE_OFF 0
+#define MEM_TRACE_ON 1
+#define MEM_TRACE_DUMP 2
+
+typedef struct mem_trace_info {
+    uint8_t active;
+    uint32_t capacity;
+    uint64_t records;
+    uint64_t overwritten;
+} mem_trace_info_t;
+
+/* Checked by the allocators' hooks next to mem_profile_active */
+extern volatile bool mem_trace_active;
+
+void mem_trace_record(bool is_alloc, void *ptr, size_t size);
+
+/* Takes the ring buffer from the frame allocator; like mem_profile_init, before mem_init */
+void mem_trace_init(void);
+
+/*
+ * ON clears the buffer and starts recording, OFF stops. DUMP writes the
+ * buffer to the serial port, one "A|F tick pid size ptr" line per record,
+ * and returns how many were written; recording pauses while it runs. ON and
+ * DUMP fail while another dump is in progress. -1 on failure.
+ */
+int64_t mem_trace_control(uint32_t command);
+
+int32_t mem_trace_get_info(mem_trace_info_t *info);
+
+#endif
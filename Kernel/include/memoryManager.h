@@ -5,14 +5,61 @@
 #include <stddef.h>
 #include <stdint.h>
 
+#define MEM_STATS_ORDERS 32
+
+/*
+ * Counters every allocator keeps up to date on each alloc/free, so reading
+ * them never walks the heap. free_blocks[k] counts free blocks whose size is
+ * in [2^k, 2^(k+1)); for buddy that is exactly the free list of order k.
+ */
+typedef struct mem_stats {
+    size_t total;
+    size_t used;
+    size_t free;
+    size_t peak_used;
+    size_t largest_free;
+    size_t allocations;
+    size_t free_blocks[MEM_STATS_ORDERS];
+} mem_stats_t;
+
 void mem_init(void);
 
 void *mem_alloc(size_t size);
 
+/*
+ * Block whose address is a multiple of align, which must be a power of two.
+ * It is released with mem_free like any other block. Returns NULL for a bad
+ * align or when no free block can be cut to that boundary.
+ */
+void *mem_alloc_aligned(size_t size, size_t align);
+
+/* mem_alloc with the first size bytes cleared */
+void *mem_alloc_zeroed(size_t size);
+
+/*
+ * Resizes the block at ptr, keeping its contents up to the smaller size.
+ * Grows in place when the memory right after the block is free and shrinks
+ * by splitting the tail off; only otherwise does it allocate, copy and free.
+ * NULL behaves as mem_alloc and size 0 as mem_free. On failure returns NULL
+ * and leaves ptr untouched.
+ */
+void *mem_realloc(void *ptr, size_t size);
+
 void mem_free(void *ptr);
 
+/*
+ * Same as mem_free for callers that know the size they asked for. Every
+ * manager frees by what it recorded for the block; size is not trusted.
+ */
+void mem_free_sized(void *ptr, size_t size);
+
+/* Bytes actually reserved for an allocation returned by mem_alloc, 0 if ptr is NULL */
+size_t mem_usable_size(void *ptr);
+
 void mem_status(size_t *total, size_t *used, size_t *available);
 
+void mem_get_stats(mem_stats_t *stats);
+
 int32_t print_mem_status(void);
 
 #endif
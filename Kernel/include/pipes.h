@@ -2,9 +2,14 @@
 #define KERNEL_PIPES_H
 
 #include <stdint.h>
+#include <sem.h>
 
 #define MAX_PIPES 100
+/* First allocation of a pipe's buffer, and the fixed size of the terminal pipes */
 #define PIPE_BUFFER_SIZE (1024)
+/* Most a pipe buffers unless opened or resized with another capacity */
+#define PIPE_DEFAULT_CAPACITY (16 * 1024)
+#define PIPE_MAX_CAPACITY (1024 * 1024)
 
 #define STDIN 0
 #define STDOUT 1
@@ -14,7 +19,8 @@ typedef struct pipe * pipe_t;
 
 void init_pipes(void);
 
-int open_pipe(void);
+/* capacity 0 picks PIPE_DEFAULT_CAPACITY; no memory is taken until the first write */
+int open_pipe(uint32_t capacity);
 
 int attach_to_pipe(uint8_t id);
 
@@ -34,4 +40,19 @@ void set_next_id(uint8_t id);
 
 void clear_pipe(uint8_t id);
 
+/*
+ * Sets how many bytes the pipe may buffer, like F_SETPIPE_SZ, and returns
+ * it; capacity 0 only reports the current one. Fails for the terminal
+ * pipes, above PIPE_MAX_CAPACITY and below what is already buffered.
+ */
+int resize_pipe(uint8_t id, uint32_t capacity);
+
+/*
+ * Fills up to capacity entries, two per open pipe named pipe_NNR and
+ * pipe_NNW, in the semaphore statistics format: value is the bytes
+ * buffered or the room left, waits the reads or writes, posts the
+ * transfers on the other side. Returns how many.
+ */
+int32_t pipe_snapshot(sem_info_t *buffer, uint32_t capacity);
+
 #endif
@@ -5,12 +5,17 @@
 #include <stddef.h>
 #include <stdbool.h>
 #include <sem.h>
+#include <sync.h>
+#include <waitQueue.h>
 #include <queueADT.h>
 
 #define PROCESS_FIRST_PID 1
 #define PROCESS_MAX_PROCESSES 32
 #define PROCESS_STACK_SIZE (4096 * 2)
 #define PROCESS_MAX_CHILDREN PROCESS_MAX_PROCESSES
+#define PROCESS_NAME_MAX 16
+/* Ownership header in front of every block handed to userland */
+#define PROCESS_HEAP_HEADER_SIZE 32
 
 typedef enum process_state {
     PROCESS_STATE_READY,
@@ -19,6 +24,8 @@ typedef enum process_state {
     PROCESS_STATE_TERMINATED
 } process_state_t;
 
+struct heap_block;
+
 typedef struct context{
     uint64_t rsp;
 } context_t;
@@ -40,11 +47,69 @@ typedef struct process {
     uint8_t remaining_quantum;
     uint8_t last_quantum_ticks;
     uint64_t ready_since_tick;
+    uint64_t ready_enqueued_tick;
+    uint64_t cpu_ticks;
+    uint64_t ready_wait_ticks;
+    uint64_t context_switches;
+    uint64_t heap_bytes;
+    uint64_t heap_block_count;
+    uint64_t serial;
     void *stack_base;
-    sem_t *exit_sem;
+    /* Parents in waitpid sleep here until exited is set */
+    wait_queue_t exit_waiters;
+    bool exited;
+    /* Queue this process sleeps on, NULL otherwise */
+    wait_queue_t *wait_queue;
+    int32_t wait_result;
+    struct process *wait_prev;
+    struct process *wait_next;
+    /* Address this process sleeps on in futex_wait, NULL otherwise */
+    volatile uint32_t *futex_key;
+    /* Waiter count it holds a share of in futex_wait_counted, NULL otherwise */
+    volatile uint32_t *futex_waiters;
+    /* Mutex, read and write holds per sync handle, given back on exit */
+    uint8_t sync_holds[SYNC_MAX_OBJECTS];
+    /* rwlock this process waits on as a writer, -1 otherwise */
+    int32_t sync_queued;
+    /* Pending timer wake-up from sleepTicks or a timed wait */
+    bool sleep_armed;
+    uint64_t wake_tick;
+    struct process *sleep_prev;
+    struct process *sleep_next;
     queue_t *children;
+    struct heap_block *heap_blocks;
 } process_t;
 
+/*
+ * Identity of the running process, kept at a fixed kernel address and
+ * refreshed on every dispatch so userland can read it without a syscall.
+ * serial never repeats, unlike pids and table slots.
+ */
+typedef struct process_self {
+    uint32_t pid;
+    uint32_t slot;
+    uint64_t serial;
+} process_self_t;
+
+/*
+ * Flat, pointer-free copy of a PCB handed to userland by the snapshot
+ * syscall. Tick counters are timer ticks (SECONDS_TO_TICKS per second).
+ */
+typedef struct process_info {
+    uint32_t pid;
+    uint32_t ppid;
+    char name[PROCESS_NAME_MAX];
+    uint8_t state;
+    uint8_t priority;
+    uint8_t foreground;
+    uint64_t cpu_ticks;
+    uint64_t ready_wait_ticks;
+    uint64_t context_switches;
+    uint64_t stack_used;
+    uint64_t stack_size;
+    uint64_t heap_used;
+} process_info_t;
+
 process_t *process_lookup(uint32_t pid);
 bool process_register(process_t *process);
 void process_unregister(uint32_t pid);
@@ -62,6 +127,15 @@ int32_t process_wait_children(void);
 process_t *createProcess(int argc, char **argv, uint32_t ppid, uint8_t priority, uint8_t foreground, void *entry_point);
 int32_t add_first_process(void);
 int32_t print_process_list(void);   
+int32_t process_snapshot(process_info_t *buffer, uint32_t capacity);
+const process_self_t *process_self(void);
+
+void *process_heap_alloc(process_t *process, size_t size);
+/* Payload aligned to align, a power of two; freed with process_heap_free */
+void *process_heap_alloc_aligned(process_t *process, size_t size, size_t align);
+void *process_heap_alloc_zeroed(process_t *process, size_t size);
+void *process_heap_realloc(void *ptr, size_t size);
+int32_t process_heap_free(void *ptr);
 
 bool add_child(process_t *parent, process_t *child);
 
@@ -7,8 +7,15 @@
 typedef struct queue queue_t;
 typedef struct queue_node queue_node_t;
 
+/*
+ * Built with QUEUE_IMPL=list the queue is a linked list walked through
+ * current; with QUEUE_IMPL=ring it is an array walked by index. Either way
+ * the queue must not change while an iterator is in use.
+ */
 typedef struct queue_iterator {
+    const queue_t *queue;
     const queue_node_t *current;
+    size_t index;
 } queue_iterator_t;
 
 queue_t *queue_create(void);
@@ -22,6 +22,8 @@ void scheduler_add_ready(process_t *process);
 bool scheduler_remove_ready(process_t *process);
 process_t *scheduler_current(void);
 void scheduler_clear_current(process_t *process);
+/* Charges one timer tick of CPU time to the running process */
+void scheduler_charge_tick(void);
 void *schedule_tick(void *current_rsp);
 const scheduler_metrics_t *scheduler_get_metrics(void);
 
@@ -4,21 +4,59 @@
 #include <stdint.h>
 #include <queueADT.h>
 
+/*
+ * count, waiters, waits and posts lead the struct and are shared with
+ * userland, which takes and returns uncontended units with atomic
+ * operations on them and only enters the kernel to sleep (sem_wait), or to
+ * futex_wake count when waiters is non-zero. waiters counts the processes
+ * queued on count; futex_wait_counted keeps it, so a sleeper that gets
+ * killed gives its share back and posts take the fast path again.
+ *
+ * waits and posts count every acquisition and release from either side;
+ * the blocked_* statistics cover the acquisitions that had to sleep.
+ */
 typedef struct semaphore {
+    volatile uint32_t count;
+    volatile uint32_t waiters;
+    volatile uint64_t waits;
+    volatile uint64_t posts;
     char *name;
-    uint32_t count;
-    uint8_t lock;
-    queue_t *waiting_processes;
+    uint64_t blocked_waits;
+    uint64_t blocked_ticks;
+    uint64_t max_blocked_ticks;
 } sem_t;
 
+#define SEM_NAME_MAX 24
+
+/* Flat copy of one registered semaphore for sem_snapshot; times in ticks */
+typedef struct sem_info {
+    char name[SEM_NAME_MAX];
+    uint32_t value;
+    uint32_t waiters;
+    uint64_t waits;
+    uint64_t posts;
+    uint64_t blocked_waits;
+    uint64_t blocked_ticks;
+    uint64_t max_blocked_ticks;
+} sem_info_t;
+
 sem_t *sem_create(void);
+/* Returns a semaphore from sem_create to its cache; sem_destroy it first */
+void sem_free(sem_t *sem);
 void sem_init(sem_t *sem, const char *name, uint32_t initial_count);
 void sem_destroy(sem_t *sem);
 int sem_post(sem_t *sem);
 int sem_wait(sem_t *sem);
+
+#define SEM_TIMEDOUT 1
+
+/*
+ * sem_wait that gives up after ms milliseconds, rounded up to whole timer
+ * ticks, returning SEM_TIMEDOUT. ms == 0 only takes a free unit.
+ */
+int sem_timedwait(sem_t *sem, uint32_t ms);
 int sem_waiting_count(sem_t *sem);
 int sem_get_value(sem_t *sem);
-int sem_remove_process(sem_t *sem, int pid);
 int sem_set_value(sem_t *sem, uint32_t new_value);
 
 /**
@@ -27,4 +65,7 @@ int sem_set_value(sem_t *sem, uint32_t new_value);
  */
 sem_t *sem_find(const char *name);
 
+/* Fills up to capacity entries, one per registered semaphore and then two per open pipe; returns how many */
+int32_t sem_snapshot(sem_info_t *buffer, uint32_t capacity);
+
 #endif
@@ -0,0 +1,13 @@
+#ifndef _SERIAL_H_
+#define _SERIAL_H_
+
+#include <stdint.h>
+
+/* COM1, 115200 8N1. Run QEMU with -serial file:<path> to capture it */
+#define SERIAL_COM1 0x3F8
+
+void serial_init(void);
+void serial_write(const char *buffer, uint64_t length);
+void serial_print(const char *string);
+
+#endif
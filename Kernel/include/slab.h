@@ -0,0 +1,42 @@
+#ifndef TP_SO_SLAB_H
+#define TP_SO_SLAB_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <memProfile.h>
+
+#define SLAB_SIZE 4096
+#define KMEM_CACHE_MAX 16
+#define KMEM_CACHE_NAME_MAX 16
+
+typedef struct kmem_cache kmem_cache_t;
+
+/* Snapshot of one cache as reported by kmem_cache_snapshot */
+typedef struct kmem_cache_info {
+    char name[KMEM_CACHE_NAME_MAX];
+    uint32_t object_size;
+    uint32_t objects_per_slab;
+    uint32_t slabs;
+    uint32_t partial_slabs;
+    uint32_t active_objects;
+    uint32_t total_objects;
+    uint64_t allocations;
+    uint64_t frees;
+} kmem_cache_info_t;
+
+/*
+ * Returns a cache of fixed-size objects carved out of SLAB_SIZE slabs taken
+ * from mem_alloc, or NULL when all KMEM_CACHE_MAX slots are in use. Slabs
+ * are charged to tag in the allocation profile.
+ */
+kmem_cache_t *kmem_cache_create(const char *name, size_t object_size, mem_tag_t tag);
+
+void *kmem_cache_alloc(kmem_cache_t *cache);
+
+/* Objects that do not belong to cache are ignored */
+void kmem_cache_free(kmem_cache_t *cache, void *object);
+
+/* Copies up to capacity cache descriptions into buffer and returns how many */
+int32_t kmem_cache_snapshot(kmem_cache_info_t *buffer, uint32_t capacity);
+
+#endif
@@ -0,0 +1,55 @@
+#ifndef KERNEL_SYNC_H
+#define KERNEL_SYNC_H
+
+#include <stdint.h>
+
+#define SYNC_MAX_OBJECTS 64
+
+struct process;
+
+/* Kinds of object behind a sync handle */
+typedef enum sync_type {
+    SYNC_MUTEX,
+    SYNC_COND,
+    SYNC_RWLOCK,
+    SYNC_BARRIER
+} sync_type_t;
+
+/*
+ * Mutexes, condition variables, reader-writer locks and barriers named by
+ * small integer handles, all sleeping on futexes. Every call returns -1 on
+ * a bad handle or a handle of the wrong type. Mutexes and rwlocks held by
+ * a process that dies are released when it exits.
+ */
+
+/* barrier_count is the number of parties for SYNC_BARRIER, ignored otherwise */
+int32_t sync_create(sync_type_t type, uint32_t barrier_count);
+/* Waiters still blocked on the object return -1 */
+int32_t sync_destroy(int32_t handle);
+
+/* Fails when the caller already owns the mutex */
+int32_t mutex_lock(int32_t handle);
+/* 0 when taken, 1 when it is held by someone else */
+int32_t mutex_trylock(int32_t handle);
+/* Fails unless the caller owns the mutex */
+int32_t mutex_unlock(int32_t handle);
+
+/* The caller must own mutex; it is held again when this returns 0 */
+int32_t cond_wait(int32_t cond, int32_t mutex);
+int32_t cond_signal(int32_t cond);
+/* Wakes every waiter in one operation */
+int32_t cond_broadcast(int32_t cond);
+
+/* Writers are preferred: new readers wait while a writer is queued */
+int32_t rwlock_read_lock(int32_t handle);
+int32_t rwlock_write_lock(int32_t handle);
+/* Releases the caller's write lock or one read hold */
+int32_t rwlock_unlock(int32_t handle);
+
+/* 1 for the process that completes the round, 0 for the others */
+int32_t barrier_wait(int32_t handle);
+
+/* Called from process_exit: gives back the locks process holds and its place in a writer queue */
+void sync_release_process(struct process *process);
+
+#endif
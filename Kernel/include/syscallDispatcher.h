@@ -4,6 +4,11 @@
 #include <stdint.h>
 #include <keyboard.h>
 #include <sem.h>
+#include <sync.h>
+#include <process.h>
+#include <slab.h>
+#include <memProfile.h>
+#include <memTrace.h>
 
 typedef struct {
     int64_t r15;
@@ -44,9 +49,15 @@ int32_t sys_fonts_increase_size(void);
 int32_t sys_fonts_set_size(uint8_t size);
 int32_t sys_clear_screen(void);
 int32_t sys_clear_screen_character(void);
+int32_t sys_set_cursor_position(uint64_t column, uint64_t row);
 uint16_t sys_window_width(void);
 uint16_t sys_window_height(void);
 int32_t sys_mem_status_print(void);
+int32_t sys_mem_cache_snapshot(kmem_cache_info_t *buffer, uint32_t capacity);
+int32_t sys_mem_profile_control(uint32_t command);
+int32_t sys_mem_profile_snapshot(mem_profile_info_t *buffer);
+int64_t sys_mem_trace_control(uint32_t command);
+int32_t sys_mem_trace_info(mem_trace_info_t *info);
 
 // ==================================================================
 // Date system calls
@@ -67,6 +78,11 @@ int32_t sys_fill_video_memory(uint32_t hexColor);
 // ==================================================================
 void *sys_mem_alloc(uint64_t size);
 int32_t sys_mem_free(void *ptr);
+void *sys_mem_map(uint64_t size);
+int32_t sys_mem_unmap(void *chunk);
+void *sys_mem_aligned_alloc(uint64_t align, uint64_t size);
+void *sys_mem_calloc(uint64_t count, uint64_t size);
+void *sys_mem_realloc(void *ptr, uint64_t size);
 
 // ==================================================================
 // Semaphore system calls
@@ -76,6 +92,27 @@ int32_t sys_sem_close(sem_t *sem);
 int32_t sys_sem_wait(sem_t *sem);
 int32_t sys_sem_post(sem_t *sem);
 int32_t sys_sem_set_value(sem_t *sem, uint32_t new_value);
+int32_t sys_sem_timedwait(sem_t *sem, uint32_t ms);
+int32_t sys_sem_snapshot(sem_info_t *buffer, uint32_t capacity);
+/* Futex primitives behind the userland semaphore fast path */
+int32_t sys_futex_wait(volatile uint32_t *addr, uint32_t expected);
+int32_t sys_futex_wake(volatile uint32_t *addr, uint32_t count);
+
+// ==================================================================
+// Sync object system calls
+// ==================================================================
+int32_t sys_sync_create(sync_type_t type, uint32_t barrier_count);
+int32_t sys_sync_destroy(int32_t handle);
+int32_t sys_mutex_lock(int32_t handle);
+int32_t sys_mutex_trylock(int32_t handle);
+int32_t sys_mutex_unlock(int32_t handle);
+int32_t sys_cond_wait(int32_t cond, int32_t mutex);
+int32_t sys_cond_signal(int32_t cond);
+int32_t sys_cond_broadcast(int32_t cond);
+int32_t sys_rwlock_read_lock(int32_t handle);
+int32_t sys_rwlock_write_lock(int32_t handle);
+int32_t sys_rwlock_unlock(int32_t handle);
+int32_t sys_barrier_wait(int32_t handle);
 
 // ==================================================================
 // Exec system call
@@ -91,6 +128,7 @@ int32_t sys_register_key(uint8_t scancode, SpecialKeyHandler fn);
 // Sleep system calls
 // ==================================================================
 int32_t sys_sleep_milis(uint32_t milis);
+int64_t sys_ticks_elapsed(void);
 
 // ==================================================================
 // Register snapshot system calls
@@ -113,12 +151,15 @@ int32_t sys_process_wait_pid(uint32_t pid);
 int32_t sys_process_wait_children(void);
 int32_t sys_process_give_foreground(uint64_t target_pid);
 int32_t sys_process_get_foreground(void);
+int32_t sys_process_snapshot(process_info_t *buffer, uint32_t capacity);
+const process_self_t *sys_process_self(void);
 
 // ==================================================================
 // Pipes and FD target system calls
 // ==================================================================
-int32_t sys_open_pipe(void);
+int32_t sys_open_pipe(uint32_t capacity);
 int32_t sys_set_fd_targets(uint64_t read_target, uint64_t write_target, uint64_t error_target);
 int32_t sys_clear_pipe(uint64_t pipe_id);
+int32_t sys_resize_pipe(uint64_t pipe_id, uint32_t capacity);
 
 #endif
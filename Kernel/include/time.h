@@ -2,6 +2,9 @@
 #define _TIME_H_
 
 #include <stdint.h>
+#include <stdbool.h>
+
+struct process;
 
 #define SECONDS_TO_TICKS 18
 
@@ -11,4 +14,13 @@ int seconds_elapsed();
 void sleep(int seconds);
 void sleepTicks(uint64_t sleep_t);
 
+/*
+ * Queues a timer wake-up for process in sleep_t ticks without blocking it,
+ * replacing any pending one; sleep_cancel withdraws it in O(1). Neither
+ * allocates, so arming only fails for a NULL process. When it fires the
+ * process leaves its wait queue with WAIT_TIMEDOUT and is unblocked.
+ */
+bool sleep_arm(struct process *process, uint64_t sleep_t);
+void sleep_cancel(struct process *process);
+
 #endif
@@ -0,0 +1,68 @@
+#ifndef KERNEL_WAIT_QUEUE_H
+#define KERNEL_WAIT_QUEUE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+struct process;
+
+/* wait_event and wait_queue_sleep results */
+#define WAIT_WOKEN 0
+#define WAIT_RELEASED 2
+#define WAIT_TIMEDOUT 3
+
+/*
+ * Processes sleeping on some event, linked through their PCBs. The queue
+ * itself is three words embedded in whatever owns the event and never
+ * allocates; an all-zero queue is empty, so structures cleared with memset
+ * need no further setup. A process sits on at most one queue at a time.
+ */
+typedef struct wait_queue {
+    struct process *head;
+    struct process *tail;
+    uint32_t count;
+} wait_queue_t;
+
+/* Evaluated with interrupts disabled; must not block */
+typedef bool (*wait_condition_t)(void *context);
+
+void wait_queue_init(wait_queue_t *queue);
+
+/*
+ * Sleeps on queue until condition(context) holds. The condition is checked
+ * with interrupts disabled right before every enqueue, so a wake that
+ * happens after it fails is never lost. Returns WAIT_WOKEN once the
+ * condition holds, WAIT_RELEASED when the queue was torn down with
+ * wait_queue_release and -1 when it would have to sleep with no running
+ * process.
+ */
+int32_t wait_event(wait_queue_t *queue, wait_condition_t condition, void *context);
+
+/* wait_event that gives up after timeout_ticks (0 waits forever) with WAIT_TIMEDOUT */
+int32_t wait_event_timeout(wait_queue_t *queue, wait_condition_t condition, void *context, uint64_t timeout_ticks);
+
+/*
+ * Building block for wait_event: queues the running process, blocks it and
+ * switches away. Must be called with interrupts disabled and returns with
+ * them still disabled, after a wake, a timeout (with WAIT_TIMEDOUT) or a
+ * spurious unblock (WAIT_WOKEN; callers re-check their condition).
+ */
+int32_t wait_queue_sleep(wait_queue_t *queue, uint64_t timeout_ticks);
+
+/* Wake the oldest sleeper or all of them; return how many woke */
+int32_t wake_one(wait_queue_t *queue);
+int32_t wake_all(wait_queue_t *queue);
+
+/* Wakes up to count sleepers, oldest first, handing each of them result */
+int32_t wait_queue_wake(wait_queue_t *queue, uint32_t count, int32_t result);
+
+/* Wakes everyone with WAIT_RELEASED, for a queue about to be freed */
+void wait_queue_release(wait_queue_t *queue);
+
+/* Takes a process off its queue without waking it, e.g. when it is killed */
+void wait_queue_cancel(struct process *process);
+
+/* Called by the timer when a timed sleep expires; false if it already woke */
+bool wait_queue_timeout(struct process *process);
+
+#endif
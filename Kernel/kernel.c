@@ -10,6 +10,10 @@
 #include <syscallDispatcher.h>
 #include <sound.h>
 #include <memoryManager.h>
+#include <frameAllocator.h>
+#include <memProfile.h>
+#include <memTrace.h>
+#include <serial.h>
 #include <scheduler.h>
 #include <process.h>
 #include <interrupts.h>
@@ -24,6 +28,8 @@ extern uint8_t endOfKernel;
 static const uint64_t PageSize = 0x1000;
 
 static void * const shellModuleAddress = (void *)0x400000;
+/* Room left for the shell's code, data and bss; its bss size is not known here */
+static const uint64_t ShellModuleSpan = 0x400000;
 
 typedef int (*EntryPoint)();
 
@@ -51,11 +57,23 @@ void * initializeKernelBinary(){
 	return getStackBase();
 }
 
+static void initializePhysicalMemory() {
+	frames_init();
+	/* Pure64's tables, the kernel image and the kernel stack right above it */
+	frames_reserve(0, (uint64_t)getStackBase() + sizeof(uint64_t));
+	frames_reserve((uint64_t)shellModuleAddress, (uint64_t)shellModuleAddress + ShellModuleSpan);
+	/* mem_init takes every frame left, so the profiler and tracer buffers come first */
+	mem_profile_init();
+	mem_trace_init();
+}
+
 int main(){	
 	load_idt();
     
 	_cli();
 	
+	serial_init();
+	initializePhysicalMemory();
 	mem_init();
 	process_table_init();
 	scheduler_init();
@@ -81,16 +81,36 @@ uint32_t uint_to_base(uint64_t value, char *buffer, uint32_t base)
 	return i;
 }
 
-int32_t print_mem_status_common(size_t total, size_t used, size_t available) {
-    print("=== Memory Status ===\n");
-    print("Total: ");
-    printDec((uint64_t)total);
-    newLine();
-    print("Used:  ");
-    printDec((uint64_t)used);
+static void print_mem_line(const char *label, uint64_t value) {
+    print(label);
+    printDec(value);
     newLine();
-    print("Free:  ");
-    printDec((uint64_t)available);
+}
+
+int32_t print_mem_status_common(const mem_stats_t *stats) {
+    print("=== Memory Status ===\n");
+    print_mem_line("Total: ", stats->total);
+    print_mem_line("Used:  ", stats->used);
+    print_mem_line("Free:  ", stats->free);
+    print_mem_line("Peak:  ", stats->peak_used);
+    print_mem_line("Allocations:   ", stats->allocations);
+    print_mem_line("Largest free:  ", stats->largest_free);
+
+    /* External fragmentation: share of free memory outside the largest block */
+    print("Fragmentation: ");
+    printDec(stats->free == 0 ? 0 : 100 - (uint64_t)stats->largest_free * 100 / stats->free);
+    print("%\n");
+
+    print("Free blocks by size:");
+    for (int order = 0; order < MEM_STATS_ORDERS; order++) {
+        if (stats->free_blocks[order] == 0) {
+            continue;
+        }
+        print(" 2^");
+        printDec(order);
+        print("=");
+        printDec(stats->free_blocks[order]);
+    }
     newLine();
     return 0;
 }
@@ -3,249 +3,518 @@
 #include <stddef.h>
 #include <stdint.h>
 #include <memoryManager.h>
+#include <memProfile.h>
+#include <frameAllocator.h>
 #include <interrupts.h>
 #include <lib.h>
 
-#define HEAP_ORDER_MIN 5
-#define HEAP_ORDER_MAX 19
-#define HEAP_SIZE (1u << HEAP_ORDER_MAX)
-#define TREE_LEVELS (HEAP_ORDER_MAX - HEAP_ORDER_MIN + 1)
-#define NODE_COUNT ((1u << TREE_LEVELS) - 1)
-
-typedef enum {
-    NODE_FREE = 0,
-    NODE_SPLIT,
-    NODE_USED
-} NodeState;
-
-typedef struct BuddyNode {
-    struct BuddyNode *parent;
-    struct BuddyNode *left;
-    struct BuddyNode *right;
-    uint8_t order;
-    NodeState state;
+#define BLOCK_ORDER_MIN 5
+#define ARENA_ORDER_MIN 16
+#define ARENA_ORDER_MAX 26
+#define ORDER_COUNT (ARENA_ORDER_MAX - BLOCK_ORDER_MIN + 1)
+#define ARENA_MAX 64
+
+/*
+ * order_map keeps one nibble per minimum block: 0 means no allocation starts
+ * there, 1..LARGE_NIBBLE - 1 encode the order directly and LARGE_NIBBLE sends
+ * the lookup to large_orders, which has one slot per LARGE_ORDER block.
+ */
+#define LARGE_NIBBLE 0xF
+#define LARGE_ORDER (BLOCK_ORDER_MIN + LARGE_NIBBLE - 1)
+#define LARGE_SLOTS (1u << (ARENA_ORDER_MAX - LARGE_ORDER))
+
+typedef struct FreeBlock {
+    struct FreeBlock *prev;
+    struct FreeBlock *next;
+} FreeBlock;
+
+/*
+ * A power-of-two span of physical memory managed as its own buddy tree.
+ * Allocated blocks carry no header; their order lives in order_map. Free
+ * blocks reuse their payload for the free list links.
+ */
+typedef struct Arena {
     uint8_t *base;
-} BuddyNode;
-
-typedef struct AllocationHeader {
-    BuddyNode *node;
-} AllocationHeader;
-
-static uint8_t heap[HEAP_SIZE];
-static BuddyNode nodes[NODE_COUNT];
-static BuddyNode *root = NULL;
+    int order;
+    /* One bit per node of the implicit tree, set while the block is on a free list */
+    uint64_t *free_map;
+    uint8_t *order_map;
+    uint8_t large_orders[LARGE_SLOTS];
+    FreeBlock *free_lists[ORDER_COUNT];
+    size_t free_counts[ORDER_COUNT];
+} Arena;
+
+static Arena arenas[ARENA_MAX];
+static int arena_count = 0;
+static int initialized = 0;
+
+static size_t total_bytes = 0;
+static size_t used_bytes = 0;
+static size_t peak_used_bytes = 0;
+static size_t live_allocations = 0;
 
 static size_t block_size(int order) {
     return (size_t)1u << order;
 }
 
-static BuddyNode *build_tree(int index, int order, uint8_t *base) {
-    BuddyNode *node = &nodes[index];
-    node->parent = NULL;
-    node->left = NULL;
-    node->right = NULL;
-    node->order = (uint8_t)order;
-    node->state = NODE_FREE;
-    node->base = base;
+static int required_order(size_t size) {
+    int order = BLOCK_ORDER_MIN;
 
-    if (order > HEAP_ORDER_MIN) {
-        int left_index = (index * 2) + 1;
-        int right_index = left_index + 1;
-        size_t half = block_size(order - 1);
+    while (order <= ARENA_ORDER_MAX && block_size(order) < size) {
+        order++;
+    }
 
-        BuddyNode *left = build_tree(left_index, order - 1, base);
-        BuddyNode *right = build_tree(right_index, order - 1, base + half);
+    return order;
+}
 
-        left->parent = node;
-        right->parent = node;
-        node->left = left;
-        node->right = right;
-    }
+static size_t free_map_bytes(int arena_order) {
+    size_t nodes = block_size(arena_order - BLOCK_ORDER_MIN + 1) - 1;
+    return (nodes + 63) / 64 * sizeof(uint64_t);
+}
 
-    return node;
+static size_t order_map_bytes(int arena_order) {
+    return block_size(arena_order - BLOCK_ORDER_MIN) / 2;
 }
 
-static int required_order(size_t size) {
-    int order = HEAP_ORDER_MIN;
+/* Frames needed for an arena of the given order plus its maps */
+static size_t arena_frames(int arena_order) {
+    size_t bytes = block_size(arena_order) + free_map_bytes(arena_order) + order_map_bytes(arena_order);
+    return (bytes + FRAME_SIZE - 1) / FRAME_SIZE;
+}
 
-    while (order <= HEAP_ORDER_MAX && block_size(order) < size) {
-        order++;
+static size_t offset_of(const Arena *arena, const void *block) {
+    return (size_t)((const uint8_t *)block - arena->base);
+}
+
+static Arena *arena_of(const void *ptr) {
+    for (int i = 0; i < arena_count; i++) {
+        const uint8_t *base = arenas[i].base;
+        if ((const uint8_t *)ptr >= base && (const uint8_t *)ptr < base + block_size(arenas[i].order)) {
+            return &arenas[i];
+        }
     }
+    return NULL;
+}
 
-    return order;
+static size_t node_index(const Arena *arena, size_t offset, int order) {
+    return ((size_t)1u << (arena->order - order)) - 1 + (offset >> order);
 }
 
-static BuddyNode *acquire_node(BuddyNode *node, int order) {
-    if (node == NULL) {
-        return NULL;
-    }
+static int is_free(const Arena *arena, size_t offset, int order) {
+    size_t index = node_index(arena, offset, order);
+    return (arena->free_map[index / 64] >> (index % 64)) & 1u;
+}
 
-    if (node->state == NODE_USED) {
-        return NULL;
+static void set_free(Arena *arena, size_t offset, int order, int free) {
+    size_t index = node_index(arena, offset, order);
+    if (free) {
+        arena->free_map[index / 64] |= (uint64_t)1u << (index % 64);
+    } else {
+        arena->free_map[index / 64] &= ~((uint64_t)1u << (index % 64));
     }
+}
 
-    if (node->order < order) {
-        return NULL;
-    }
+static int order_map_get(const Arena *arena, size_t offset) {
+    size_t slot = offset >> BLOCK_ORDER_MIN;
+    uint8_t value = (arena->order_map[slot / 2] >> ((slot % 2) * 4)) & 0xF;
 
-    if (node->order == order) {
-        if (node->state == NODE_FREE) {
-            node->state = NODE_USED;
-            return node;
-        }
-        return NULL;
+    if (value == 0) {
+        return -1;
     }
-
-    if (node->left == NULL || node->right == NULL) {
-        return NULL;
+    if (value == LARGE_NIBBLE) {
+        return arena->large_orders[offset >> LARGE_ORDER];
     }
+    return value - 1 + BLOCK_ORDER_MIN;
+}
 
-    if (node->state == NODE_FREE) {
-        node->state = NODE_SPLIT;
-    }
+static void order_map_set(Arena *arena, size_t offset, int order) {
+    size_t slot = offset >> BLOCK_ORDER_MIN;
+    uint8_t value = 0;
 
-    BuddyNode *result = acquire_node(node->left, order);
-    if (result != NULL) {
-        return result;
+    if (order >= LARGE_ORDER) {
+        arena->large_orders[offset >> LARGE_ORDER] = (uint8_t)order;
+        value = LARGE_NIBBLE;
+    } else if (order >= 0) {
+        value = (uint8_t)(order - BLOCK_ORDER_MIN + 1);
     }
 
-    result = acquire_node(node->right, order);
-    if (result != NULL) {
-        return result;
+    int shift = (slot % 2) * 4;
+    arena->order_map[slot / 2] = (uint8_t)((arena->order_map[slot / 2] & ~(0xF << shift)) | (value << shift));
+}
+
+static void free_list_push(Arena *arena, FreeBlock *block, int order) {
+    FreeBlock **head = &arena->free_lists[order - BLOCK_ORDER_MIN];
+
+    set_free(arena, offset_of(arena, block), order, 1);
+    arena->free_counts[order - BLOCK_ORDER_MIN]++;
+    block->prev = NULL;
+    block->next = *head;
+    if (*head != NULL) {
+        (*head)->prev = block;
     }
+    *head = block;
+}
+
+static void free_list_remove(Arena *arena, FreeBlock *block, int order) {
+    FreeBlock **head = &arena->free_lists[order - BLOCK_ORDER_MIN];
 
-    if (node->left->state == NODE_FREE && node->right->state == NODE_FREE) {
-        node->state = NODE_FREE;
+    if (block->prev != NULL) {
+        block->prev->next = block->next;
+    } else {
+        *head = block->next;
+    }
+    if (block->next != NULL) {
+        block->next->prev = block->prev;
     }
 
-    return NULL;
+    set_free(arena, offset_of(arena, block), order, 0);
+    arena->free_counts[order - BLOCK_ORDER_MIN]--;
+    block->prev = NULL;
+    block->next = NULL;
 }
 
-static void coalesce_up(BuddyNode *node) {
-    while (node != NULL) {
-        if (node->left != NULL && node->right != NULL) {
-            if (node->left->state == NODE_FREE && node->right->state == NODE_FREE) {
-                node->state = NODE_FREE;
-                node = node->parent;
-            } else {
-                node->state = NODE_SPLIT;
-                node = NULL;
-            }
-        } else {
-            node = node->parent;
-        }
+static void arena_reset(Arena *arena) {
+    for (int i = 0; i < ORDER_COUNT; i++) {
+        arena->free_lists[i] = NULL;
+        arena->free_counts[i] = 0;
     }
+    memset(arena->free_map, 0, free_map_bytes(arena->order));
+    memset(arena->order_map, 0, order_map_bytes(arena->order));
+    memset(arena->large_orders, 0, sizeof(arena->large_orders));
+    free_list_push(arena, (FreeBlock *)arena->base, arena->order);
 }
 
-static size_t free_bytes(const BuddyNode *node) {
-    if (node == NULL) {
-        return 0;
+/* Carves arenas out of the frame allocator, biggest first, until it runs dry */
+static void arenas_create(void) {
+    while (arena_count < ARENA_MAX) {
+        size_t run = frames_largest_run();
+        int order = ARENA_ORDER_MAX;
+        while (order >= ARENA_ORDER_MIN && arena_frames(order) > run) {
+            order--;
+        }
+        if (order < ARENA_ORDER_MIN) {
+            break;
+        }
+
+        uint8_t *memory = frames_alloc(arena_frames(order));
+        if (memory == NULL) {
+            break;
+        }
+
+        Arena *arena = &arenas[arena_count++];
+        arena->base = memory;
+        arena->order = order;
+        arena->free_map = (uint64_t *)(memory + block_size(order));
+        arena->order_map = memory + block_size(order) + free_map_bytes(order);
+        total_bytes += block_size(order);
     }
+}
 
-    if (node->state == NODE_FREE) {
-        return block_size(node->order);
+/* Order of the live allocation starting at ptr, or -1 if ptr is not one */
+static int allocation_order(const Arena *arena, void *ptr) {
+    size_t offset = offset_of(arena, ptr);
+    if ((offset & (block_size(BLOCK_ORDER_MIN) - 1)) != 0) {
+        return -1;
     }
 
-    if (node->state == NODE_SPLIT) {
-        return free_bytes(node->left) + free_bytes(node->right);
+    return order_map_get(arena, offset);
+}
+
+static void release(Arena *arena, size_t offset, int order) {
+    order_map_set(arena, offset, -1);
+    used_bytes -= block_size(order);
+    live_allocations--;
+
+    while (order < arena->order) {
+        size_t buddy = offset ^ block_size(order);
+        if (!is_free(arena, buddy, order)) {
+            break;
+        }
+        free_list_remove(arena, (FreeBlock *)(arena->base + buddy), order);
+        offset &= ~block_size(order);
+        order++;
     }
 
-    return 0;
+    free_list_push(arena, (FreeBlock *)(arena->base + offset), order);
 }
 
 void mem_init(void) {
     uint64_t flags = interrupts_save_and_disable();
-    root = build_tree(0, HEAP_ORDER_MAX, heap);
+    /* Frames are handed out once; later calls only reset the arenas already built */
+    if (arena_count == 0) {
+        arenas_create();
+    }
+    for (int i = 0; i < arena_count; i++) {
+        arena_reset(&arenas[i]);
+    }
+    used_bytes = 0;
+    peak_used_bytes = 0;
+    live_allocations = 0;
+    initialized = 1;
     interrupts_restore(flags);
 }
 
+/* Takes a block of the given order from arena, splitting a larger one if needed */
+static void *arena_alloc(Arena *arena, int order) {
+    int current = order;
+    while (current <= arena->order && arena->free_lists[current - BLOCK_ORDER_MIN] == NULL) {
+        current++;
+    }
+    if (current > arena->order) {
+        return NULL;
+    }
+
+    FreeBlock *block = arena->free_lists[current - BLOCK_ORDER_MIN];
+    free_list_remove(arena, block, current);
+
+    while (current > order) {
+        current--;
+        free_list_push(arena, (FreeBlock *)((uint8_t *)block + block_size(current)), current);
+    }
+
+    order_map_set(arena, offset_of(arena, block), order);
+    used_bytes += block_size(order);
+    if (used_bytes > peak_used_bytes) {
+        peak_used_bytes = used_bytes;
+    }
+    live_allocations++;
+    return block;
+}
+
 void *mem_alloc(size_t size) {
     uint64_t flags = interrupts_save_and_disable();
     void *result = NULL;
 
-    if (root == NULL) {
+    if (!initialized) {
         mem_init();
     }
 
-    if (size == 0 || size > HEAP_SIZE) {
+    if (size == 0 || size > block_size(ARENA_ORDER_MAX)) {
         goto out;
     }
 
-    if (size > HEAP_SIZE - sizeof(AllocationHeader)) {
-        goto out;
+    int order = required_order(size);
+    for (int i = 0; i < arena_count && result == NULL; i++) {
+        result = arena_alloc(&arenas[i], order);
     }
 
-    size_t total = size + sizeof(AllocationHeader);
-    int order = required_order(total);
+    MEM_PROFILE_ALLOC(result, size);
+out:
+    interrupts_restore(flags);
+    return result;
+}
 
-    if (order > HEAP_ORDER_MAX) {
-        goto out;
+/*
+ * A block of order k sits at an offset that is a multiple of 2^k, so raising
+ * the order to the alignment is enough as long as the arena base is aligned
+ * too. Arenas come from whole frames, so page alignment always works.
+ */
+void *mem_alloc_aligned(size_t size, size_t align) {
+    if (align == 0 || (align & (align - 1)) != 0) {
+        return NULL;
+    }
+    if (align <= block_size(BLOCK_ORDER_MIN)) {
+        return mem_alloc(size);
     }
 
-    BuddyNode *node = acquire_node(root, order);
-    if (node == NULL) {
+    uint64_t flags = interrupts_save_and_disable();
+    void *result = NULL;
+
+    if (!initialized) {
+        mem_init();
+    }
+
+    if (size == 0 || size > block_size(ARENA_ORDER_MAX) || align > block_size(ARENA_ORDER_MAX)) {
         goto out;
     }
 
-    AllocationHeader *header = (AllocationHeader *)node->base;
-    header->node = node;
-    result = node->base + sizeof(AllocationHeader);
+    int order = required_order(size > align ? size : align);
+    for (int i = 0; i < arena_count && result == NULL; i++) {
+        if (((uintptr_t)arenas[i].base & (align - 1)) == 0) {
+            result = arena_alloc(&arenas[i], order);
+        }
+    }
 
+    MEM_PROFILE_ALLOC(result, size);
 out:
     interrupts_restore(flags);
     return result;
 }
 
+void *mem_alloc_zeroed(size_t size) {
+    void *result = mem_alloc(size);
+    if (result != NULL) {
+        memzero(result, size);
+    }
+    return result;
+}
+
 void mem_free(void *ptr) {
-    uint64_t flags = interrupts_save_and_disable();
     if (ptr == NULL) {
-        interrupts_restore(flags);
         return;
     }
 
-    if (root == NULL) {
-        interrupts_restore(flags);
-        return;
+    uint64_t flags = interrupts_save_and_disable();
+    Arena *arena = initialized ? arena_of(ptr) : NULL;
+    if (arena != NULL) {
+        int order = allocation_order(arena, ptr);
+        if (order >= 0) {
+            release(arena, offset_of(arena, ptr), order);
+            /* Only blocks actually released count as frees */
+            MEM_PROFILE_FREE(ptr);
+        }
     }
+    interrupts_restore(flags);
+}
 
-    AllocationHeader *header = (AllocationHeader *)((uint8_t *)ptr - sizeof(AllocationHeader));
-    BuddyNode *node = header->node;
+/*
+ * The order map already holds the exact order, so reading it costs the same
+ * as deriving it from size, and a wrong size must not leak the block.
+ */
+void mem_free_sized(void *ptr, size_t size) {
+    (void) size;
+    mem_free(ptr);
+}
 
-    if (node == NULL || node->state != NODE_USED) {
-        interrupts_restore(flags);
-        return;
+/*
+ * Grows a block by absorbing its free buddies, which only works while the
+ * block is the lower half at every level, and shrinks it by handing back
+ * upper halves. Returns 0 when the block has to move.
+ */
+static int resize_in_place(Arena *arena, size_t offset, int order, int target) {
+    if (target > arena->order) {
+        return 0;
+    }
+
+    if (target > order) {
+        for (int level = order; level < target; level++) {
+            size_t buddy = offset ^ block_size(level);
+            if (buddy < offset || !is_free(arena, buddy, level)) {
+                return 0;
+            }
+        }
+        for (int level = order; level < target; level++) {
+            free_list_remove(arena, (FreeBlock *)(arena->base + offset + block_size(level)), level);
+        }
+        used_bytes += block_size(target) - block_size(order);
+        if (used_bytes > peak_used_bytes) {
+            peak_used_bytes = used_bytes;
+        }
+    } else {
+        /* The upper halves cannot merge back: their buddies are still in use */
+        for (int level = order - 1; level >= target; level--) {
+            free_list_push(arena, (FreeBlock *)(arena->base + offset + block_size(level)), level);
+        }
+        used_bytes -= block_size(order) - block_size(target);
     }
 
-    header->node = NULL;
-    node->state = NODE_FREE;
-    coalesce_up(node->parent);
+    order_map_set(arena, offset, target);
+    return 1;
+}
+
+void *mem_realloc(void *ptr, size_t size) {
+    if (ptr == NULL) {
+        return mem_alloc(size);
+    }
+    if (size == 0) {
+        mem_free(ptr);
+        return NULL;
+    }
+
+    uint64_t flags = interrupts_save_and_disable();
+    void *result = NULL;
+    Arena *arena = initialized ? arena_of(ptr) : NULL;
+    int order = arena != NULL ? allocation_order(arena, ptr) : -1;
+    if (order < 0 || size > block_size(ARENA_ORDER_MAX)) {
+        goto out;
+    }
+    MEM_PROFILE_REALLOC_BEGIN(ptr);
+
+    int target = required_order(size);
+    if (target == order || resize_in_place(arena, offset_of(arena, ptr), order, target)) {
+        MEM_PROFILE_FREE(ptr);
+        MEM_PROFILE_ALLOC(ptr, size);
+        MEM_PROFILE_REALLOC_END();
+        result = ptr;
+        goto out;
+    }
+
+    result = mem_alloc(size);
+    if (result != NULL) {
+        size_t old_size = block_size(order);
+        memcpy(result, ptr, old_size < size ? old_size : size);
+        mem_free(ptr);
+    }
+    MEM_PROFILE_REALLOC_END();
+
+out:
     interrupts_restore(flags);
+    return result;
+}
+
+size_t mem_usable_size(void *ptr) {
+    if (ptr == NULL || !initialized) {
+        return 0;
+    }
+
+    uint64_t flags = interrupts_save_and_disable();
+    Arena *arena = arena_of(ptr);
+    int order = arena != NULL ? allocation_order(arena, ptr) : -1;
+    size_t size = order >= 0 ? block_size(order) : 0;
+    interrupts_restore(flags);
+    return size;
 }
 
 void mem_status(size_t *total, size_t *used, size_t *available) {
     uint64_t flags = interrupts_save_and_disable();
-    if (root == NULL) {
+    if (!initialized) {
         mem_init();
     }
 
     if (total != NULL) {
-        *total = HEAP_SIZE;
+        *total = total_bytes;
     }
 
-    size_t free_total = free_bytes(root);
-
     if (available != NULL) {
-        *available = free_total;
+        *available = total_bytes - used_bytes;
     }
 
     if (used != NULL) {
-        *used = HEAP_SIZE - free_total;
+        *used = used_bytes;
+    }
+    interrupts_restore(flags);
+}
+
+void mem_get_stats(mem_stats_t *stats) {
+    if (stats == NULL) {
+        return;
+    }
+
+    uint64_t flags = interrupts_save_and_disable();
+    if (!initialized) {
+        mem_init();
+    }
+
+    memset(stats, 0, sizeof(*stats));
+    stats->total = total_bytes;
+    stats->used = used_bytes;
+    stats->free = total_bytes - used_bytes;
+    stats->peak_used = peak_used_bytes;
+    stats->allocations = live_allocations;
+    for (int i = 0; i < arena_count; i++) {
+        for (int order = BLOCK_ORDER_MIN; order <= arenas[i].order; order++) {
+            size_t count = arenas[i].free_counts[order - BLOCK_ORDER_MIN];
+            stats->free_blocks[order] += count;
+            if (count != 0 && block_size(order) > stats->largest_free) {
+                stats->largest_free = block_size(order);
+            }
+        }
     }
     interrupts_restore(flags);
 }
 
 int32_t print_mem_status(void) {
-    size_t total = 0, used = 0, available = 0;
-    mem_status(&total, &used, &available);
-    return print_mem_status_common(total, used, available);
+    mem_stats_t stats;
+    mem_get_stats(&stats);
+    return print_mem_status_common(&stats);
 }
@@ -0,0 +1,127 @@
+// This is a personal academic project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+#include <stddef.h>
+#include <stdint.h>
+#include <frameAllocator.h>
+#include <interrupts.h>
+
+typedef struct e820_entry {
+    uint64_t base;
+    uint64_t length;
+    uint32_t type;
+    uint32_t acpi;
+    uint64_t padding;
+} e820_entry_t;
+
+typedef struct region {
+    uint64_t start;
+    uint64_t end;
+} region_t;
+
+static region_t regions[FRAME_REGION_MAX];
+static uint32_t region_count = 0;
+
+static uint64_t align_up(uint64_t value) {
+    return (value + FRAME_SIZE - 1) & ~((uint64_t)FRAME_SIZE - 1);
+}
+
+static uint64_t align_down(uint64_t value) {
+    return value & ~((uint64_t)FRAME_SIZE - 1);
+}
+
+static void add_region(uint64_t start, uint64_t end) {
+    start = align_up(start);
+    end = align_down(end);
+    if (start >= end || region_count >= FRAME_REGION_MAX) {
+        return;
+    }
+
+    regions[region_count].start = start;
+    regions[region_count].end = end;
+    region_count++;
+}
+
+static void remove_region(uint32_t index) {
+    for (uint32_t i = index + 1; i < region_count; i++) {
+        regions[i - 1] = regions[i];
+    }
+    region_count--;
+}
+
+void frames_init(void) {
+    region_count = 0;
+
+    /* Pure64 ends the map with an all-zero entry; entries are 32 bytes apart */
+    const e820_entry_t *entry = (const e820_entry_t *)E820_MAP_ADDRESS;
+    for (; entry->length != 0 || entry->type != 0; entry++) {
+        if (entry->type == E820_TYPE_USABLE) {
+            add_region(entry->base, entry->base + entry->length);
+        }
+    }
+
+    /* Without E820 Pure64 still reports the RAM size; assume it is contiguous from 1 MiB */
+    if (region_count == 0) {
+        uint64_t mem_amount = *(const uint32_t *)MEM_AMOUNT_ADDRESS;
+        add_region(0x100000, mem_amount << 20);
+    }
+}
+
+void frames_reserve(uint64_t start, uint64_t end) {
+    start = align_down(start);
+    end = align_up(end);
+
+    for (uint32_t i = 0; i < region_count; i++) {
+        region_t *region = &regions[i];
+        if (end <= region->start || start >= region->end) {
+            continue;
+        }
+
+        if (start <= region->start && end >= region->end) {
+            remove_region(i);
+            i--;
+        } else if (start <= region->start) {
+            region->start = end;
+        } else if (end >= region->end) {
+            region->end = start;
+        } else {
+            /* The reservation splits the region; keep the upper half as a new one */
+            uint64_t upper_end = region->end;
+            region->end = start;
+            add_region(end, upper_end);
+        }
+    }
+}
+
+void *frames_alloc(size_t count) {
+    uint64_t flags = interrupts_save_and_disable();
+    uint64_t size = (uint64_t)count * FRAME_SIZE;
+    void *result = NULL;
+
+    for (uint32_t i = 0; count != 0 && i < region_count; i++) {
+        if (regions[i].end - regions[i].start >= size) {
+            result = (void *)regions[i].start;
+            regions[i].start += size;
+            if (regions[i].start == regions[i].end) {
+                remove_region(i);
+            }
+            break;
+        }
+    }
+
+    interrupts_restore(flags);
+    return result;
+}
+
+size_t frames_largest_run(void) {
+    uint64_t flags = interrupts_save_and_disable();
+    uint64_t largest = 0;
+
+    for (uint32_t i = 0; i < region_count; i++) {
+        if (regions[i].end - regions[i].start > largest) {
+            largest = regions[i].end - regions[i].start;
+        }
+    }
+
+    interrupts_restore(flags);
+    return (size_t)(largest / FRAME_SIZE);
+}
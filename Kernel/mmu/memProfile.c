@@ -0,0 +1,342 @@
+// This is a personal academic project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <memProfile.h>
+#include <memTrace.h>
+#include <memoryManager.h>
+#include <frameAllocator.h>
+#include <interrupts.h>
+#include <time.h>
+#include <lib.h>
+
+/* Live blocks are tracked in an open-addressing table keyed by address */
+#define TRACKED_BLOCKS 8192
+#define TRACKED_MASK (TRACKED_BLOCKS - 1)
+#define SITE_SLOTS 128
+#define NO_SITE 0xFFFF
+
+typedef struct tracked_block {
+    uintptr_t ptr;
+    uint32_t size;
+    uint16_t site;
+    uint8_t tag;
+    uint8_t used;
+} tracked_block_t;
+
+volatile bool mem_profile_active = false;
+
+static tracked_block_t *tracked = NULL;
+static mem_profile_site_t sites[SITE_SLOTS];
+static uint32_t site_count = 0;
+/* Only the counters are used here; sites are picked at snapshot time */
+static mem_profile_info_t totals;
+static uint64_t started_at = 0;
+static uint64_t stopped_at = 0;
+
+/* Set by mem_alloc_tagged for the single mem_alloc it wraps */
+static mem_tag_t pending_tag = MEM_TAG_KERNEL;
+static void *pending_caller = NULL;
+
+static uint32_t hash_address(uintptr_t address) {
+    return (uint32_t)(((uint64_t)address * 0x9E3779B97F4A7C15ULL) >> 40);
+}
+
+static uint32_t bucket_of(size_t size) {
+    if (size <= 8) {
+        return 0;
+    }
+    uint32_t bucket = (uint32_t)(64 - __builtin_clzll((uint64_t)size - 1)) - 3;
+    return bucket < MEM_PROFILE_BUCKETS ? bucket : MEM_PROFILE_BUCKETS - 1;
+}
+
+static uint16_t site_of(void *caller, mem_tag_t tag) {
+    uint32_t index = hash_address((uintptr_t)caller) % SITE_SLOTS;
+    for (uint32_t probe = 0; probe < SITE_SLOTS; probe++) {
+        mem_profile_site_t *site = &sites[index];
+        if (site->address == (uint64_t)(uintptr_t)caller && site->tag == (uint32_t)tag) {
+            return (uint16_t)index;
+        }
+        if (site->address == 0) {
+            site->address = (uint64_t)(uintptr_t)caller;
+            site->tag = (uint32_t)tag;
+            site_count++;
+            return (uint16_t)index;
+        }
+        index = (index + 1) % SITE_SLOTS;
+    }
+    return NO_SITE;
+}
+
+static void usage_add(mem_profile_usage_t *usage, uint32_t size) {
+    usage->live_bytes += size;
+    usage->live_blocks++;
+}
+
+static void usage_remove(mem_profile_usage_t *usage, uint32_t size) {
+    usage->live_bytes = usage->live_bytes > size ? usage->live_bytes - size : 0;
+    if (usage->live_blocks > 0) {
+        usage->live_blocks--;
+    }
+}
+
+static tracked_block_t *tracked_insert(uintptr_t ptr) {
+    uint32_t index = hash_address(ptr) & TRACKED_MASK;
+    for (uint32_t probe = 0; probe < TRACKED_BLOCKS; probe++) {
+        tracked_block_t *entry = &tracked[index];
+        if (!entry->used || entry->ptr == ptr) {
+            return entry;
+        }
+        index = (index + 1) & TRACKED_MASK;
+    }
+    return NULL;
+}
+
+static int32_t tracked_find(uintptr_t ptr) {
+    uint32_t index = hash_address(ptr) & TRACKED_MASK;
+    for (uint32_t probe = 0; probe < TRACKED_BLOCKS; probe++) {
+        tracked_block_t *entry = &tracked[index];
+        if (!entry->used) {
+            return -1;
+        }
+        if (entry->ptr == ptr) {
+            return (int32_t)index;
+        }
+        index = (index + 1) & TRACKED_MASK;
+    }
+    return -1;
+}
+
+/* Backward-shift deletion keeps probe chains intact without tombstones */
+static void tracked_remove(uint32_t hole) {
+    uint32_t next = hole;
+    while (1) {
+        next = (next + 1) & TRACKED_MASK;
+        if (!tracked[next].used) {
+            break;
+        }
+        uint32_t home = hash_address(tracked[next].ptr) & TRACKED_MASK;
+        bool movable = hole <= next ? (home <= hole || home > next) : (home <= hole && home > next);
+        if (movable) {
+            tracked[hole] = tracked[next];
+            hole = next;
+        }
+    }
+    tracked[hole].used = 0;
+}
+
+static void profile_reset(void) {
+    memset(tracked, 0, TRACKED_BLOCKS * sizeof(tracked_block_t));
+    memset(sites, 0, sizeof(sites));
+    memset(&totals, 0, sizeof(totals));
+    site_count = 0;
+    started_at = (uint64_t)ticks_elapsed();
+    stopped_at = started_at;
+}
+
+void mem_profile_on_alloc(void *ptr, size_t size, void *caller) {
+    if (mem_trace_active) {
+        mem_trace_record(true, ptr, size);
+    }
+    if (!mem_profile_active) {
+        return;
+    }
+
+    uint64_t flags = interrupts_save_and_disable();
+    mem_tag_t tag = MEM_TAG_KERNEL;
+    if (pending_caller != NULL) {
+        caller = pending_caller;
+        tag = pending_tag;
+    }
+
+    uint32_t block_size = size > UINT32_MAX ? UINT32_MAX : (uint32_t)size;
+    totals.allocations++;
+    totals.histogram[bucket_of(size)]++;
+    totals.tags[tag].allocations++;
+
+    tracked_block_t *entry = tracked_insert((uintptr_t)ptr);
+    if (entry == NULL) {
+        totals.dropped++;
+        interrupts_restore(flags);
+        return;
+    }
+
+    /* Same address handed out again: its free happened while untracked */
+    if (entry->used) {
+        totals.live_bytes = totals.live_bytes > entry->size ? totals.live_bytes - entry->size : 0;
+        usage_remove(&totals.tags[entry->tag], entry->size);
+        if (entry->site != NO_SITE) {
+            usage_remove(&sites[entry->site].usage, entry->size);
+        }
+    }
+
+    uint16_t site = site_of(caller, tag);
+    entry->ptr = (uintptr_t)ptr;
+    entry->size = block_size;
+    entry->site = site;
+    entry->tag = (uint8_t)tag;
+    entry->used = 1;
+
+    totals.live_bytes += block_size;
+    if (totals.live_bytes > totals.peak_bytes) {
+        totals.peak_bytes = totals.live_bytes;
+    }
+    usage_add(&totals.tags[tag], block_size);
+    if (site != NO_SITE) {
+        usage_add(&sites[site].usage, block_size);
+        sites[site].usage.allocations++;
+    }
+    interrupts_restore(flags);
+}
+
+void mem_profile_on_free(void *ptr) {
+    if (ptr == NULL) {
+        return;
+    }
+    if (mem_trace_active) {
+        mem_trace_record(false, ptr, 0);
+    }
+    if (!mem_profile_active) {
+        return;
+    }
+
+    uint64_t flags = interrupts_save_and_disable();
+    int32_t index = tracked_find((uintptr_t)ptr);
+    if (index < 0) {
+        totals.untracked_frees++;
+        interrupts_restore(flags);
+        return;
+    }
+
+    tracked_block_t *entry = &tracked[index];
+    totals.frees++;
+    totals.live_bytes = totals.live_bytes > entry->size ? totals.live_bytes - entry->size : 0;
+    usage_remove(&totals.tags[entry->tag], entry->size);
+    if (entry->site != NO_SITE) {
+        usage_remove(&sites[entry->site].usage, entry->size);
+    }
+    tracked_remove((uint32_t)index);
+    interrupts_restore(flags);
+}
+
+void mem_profile_inherit(void *ptr) {
+    int32_t index = tracked != NULL && ptr != NULL ? tracked_find((uintptr_t)ptr) : -1;
+    if (index < 0 || tracked[index].site == NO_SITE) {
+        return;
+    }
+    pending_tag = (mem_tag_t)tracked[index].tag;
+    pending_caller = (void *)(uintptr_t)sites[tracked[index].site].address;
+}
+
+void mem_profile_inherit_end(void) {
+    pending_caller = NULL;
+    pending_tag = MEM_TAG_KERNEL;
+}
+
+void *mem_alloc_tagged(size_t size, mem_tag_t tag) {
+    if (!mem_profile_active) {
+        return mem_alloc(size);
+    }
+
+    uint64_t flags = interrupts_save_and_disable();
+    pending_tag = tag < MEM_TAG_COUNT ? tag : MEM_TAG_KERNEL;
+    pending_caller = __builtin_return_address(0);
+    void *ptr = mem_alloc(size);
+    pending_caller = NULL;
+    pending_tag = MEM_TAG_KERNEL;
+    interrupts_restore(flags);
+    return ptr;
+}
+
+void *mem_alloc_aligned_tagged(size_t size, size_t align, mem_tag_t tag) {
+    if (!mem_profile_active) {
+        return mem_alloc_aligned(size, align);
+    }
+
+    uint64_t flags = interrupts_save_and_disable();
+    pending_tag = tag < MEM_TAG_COUNT ? tag : MEM_TAG_KERNEL;
+    pending_caller = __builtin_return_address(0);
+    void *ptr = mem_alloc_aligned(size, align);
+    pending_caller = NULL;
+    pending_tag = MEM_TAG_KERNEL;
+    interrupts_restore(flags);
+    return ptr;
+}
+
+void mem_profile_init(void) {
+    size_t frames = (TRACKED_BLOCKS * sizeof(tracked_block_t) + FRAME_SIZE - 1) / FRAME_SIZE;
+    tracked = frames_alloc(frames);
+}
+
+int32_t mem_profile_control(uint32_t command) {
+    uint64_t flags = interrupts_save_and_disable();
+    int32_t was_active = mem_profile_active ? 1 : 0;
+
+    switch (command) {
+        case MEM_PROFILE_OFF:
+            if (was_active) {
+                mem_profile_active = false;
+                stopped_at = (uint64_t)ticks_elapsed();
+            }
+            break;
+        case MEM_PROFILE_ON:
+        case MEM_PROFILE_RESET:
+            if (tracked == NULL) {
+                interrupts_restore(flags);
+                return -1;
+            }
+            /* Blocks freed while off would leave stale entries behind */
+            if (command == MEM_PROFILE_RESET || !was_active) {
+                profile_reset();
+            }
+            if (command == MEM_PROFILE_ON) {
+                mem_profile_active = true;
+            }
+            break;
+        default:
+            interrupts_restore(flags);
+            return -1;
+    }
+
+    interrupts_restore(flags);
+    return was_active;
+}
+
+int32_t mem_profile_snapshot(mem_profile_info_t *buffer) {
+    if (buffer == NULL) {
+        return -1;
+    }
+
+    uint64_t flags = interrupts_save_and_disable();
+    memcpy(buffer, &totals, sizeof(mem_profile_info_t));
+    memset(buffer->sites, 0, sizeof(buffer->sites));
+    buffer->enabled = mem_profile_active ? 1 : 0;
+    buffer->site_count = site_count;
+    buffer->ticks = (mem_profile_active ? (uint64_t)ticks_elapsed() : stopped_at) - started_at;
+
+    /* Insertion into a short sorted array; there are at most SITE_SLOTS sites */
+    uint32_t shown = 0;
+    for (uint32_t i = 0; i < SITE_SLOTS; i++) {
+        const mem_profile_site_t *site = &sites[i];
+        if (site->address == 0) {
+            continue;
+        }
+        uint32_t position = shown;
+        while (position > 0 && buffer->sites[position - 1].usage.live_bytes < site->usage.live_bytes) {
+            if (position < MEM_PROFILE_TOP_SITES) {
+                buffer->sites[position] = buffer->sites[position - 1];
+            }
+            position--;
+        }
+        if (position < MEM_PROFILE_TOP_SITES) {
+            buffer->sites[position] = *site;
+            if (shown < MEM_PROFILE_TOP_SITES) {
+                shown++;
+            }
+        }
+    }
+
+    interrupts_restore(flags);
+    return (int32_t)shown;
+}
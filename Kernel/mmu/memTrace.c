@@ -0,0 +1,167 @@
+// This is a personal academic project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <memTrace.h>
+#include <frameAllocator.h>
+#include <interrupts.h>
+#include <process.h>
+#include <serial.h>
+#include <time.h>
+#include <lib.h>
+
+#define TRACE_LINE_MAX 64
+
+typedef struct trace_record {
+    uint64_t ptr;
+    uint32_t size;
+    uint32_t tick;
+    uint16_t pid;
+    uint8_t is_alloc;
+} trace_record_t;
+
+volatile bool mem_trace_active = false;
+
+static trace_record_t *records = NULL;
+/* Records ever written; the ring slot is written % MEM_TRACE_RECORDS */
+static uint64_t written = 0;
+
+/*
+ * A dump runs with interrupts enabled and recording paused. Whether to
+ * resume afterwards is kept here so an OFF issued meanwhile still sticks.
+ */
+static bool dumping = false;
+static bool resume_after_dump = false;
+
+void mem_trace_record(bool is_alloc, void *ptr, size_t size) {
+    uint64_t flags = interrupts_save_and_disable();
+    if (!mem_trace_active || records == NULL) {
+        interrupts_restore(flags);
+        return;
+    }
+
+    int32_t pid = get_pid();
+    trace_record_t *record = &records[written % MEM_TRACE_RECORDS];
+    record->ptr = (uint64_t)(uintptr_t)ptr;
+    record->size = size > UINT32_MAX ? UINT32_MAX : (uint32_t)size;
+    record->tick = (uint32_t)ticks_elapsed();
+    record->pid = pid < 0 ? 0 : (uint16_t)pid;
+    record->is_alloc = is_alloc ? 1 : 0;
+    written++;
+    interrupts_restore(flags);
+}
+
+static uint32_t put_field(char *line, uint32_t pos, uint64_t value, uint32_t base) {
+    pos += uint_to_base(value, line + pos, base);
+    line[pos++] = ' ';
+    return pos;
+}
+
+/* Dumps the records before end, the value of written when recording paused */
+static uint64_t dump_records(uint64_t end) {
+    uint64_t count = end < MEM_TRACE_RECORDS ? end : MEM_TRACE_RECORDS;
+    uint64_t first = end - count;
+    char line[TRACE_LINE_MAX];
+
+    uint32_t pos = 0;
+    const char *header = "# memtrace records ";
+    while (header[pos] != '\0') {
+        line[pos] = header[pos];
+        pos++;
+    }
+    pos = put_field(line, pos, count, 10);
+    line[pos - 1] = '\n';
+    serial_write(line, pos);
+
+    for (uint64_t i = first; i < end; i++) {
+        trace_record_t *record = &records[i % MEM_TRACE_RECORDS];
+        pos = 0;
+        line[pos++] = record->is_alloc ? 'A' : 'F';
+        line[pos++] = ' ';
+        pos = put_field(line, pos, record->tick, 10);
+        pos = put_field(line, pos, record->pid, 10);
+        pos = put_field(line, pos, record->size, 10);
+        pos = put_field(line, pos, record->ptr, 16);
+        line[pos - 1] = '\n';
+        serial_write(line, pos);
+    }
+
+    serial_print("# memtrace end\n");
+    return count;
+}
+
+void mem_trace_init(void) {
+    size_t frames = (MEM_TRACE_RECORDS * sizeof(trace_record_t) + FRAME_SIZE - 1) / FRAME_SIZE;
+    records = frames_alloc(frames);
+}
+
+int64_t mem_trace_control(uint32_t command) {
+    uint64_t flags = interrupts_save_and_disable();
+    int64_t result = mem_trace_active || (dumping && resume_after_dump) ? 1 : 0;
+
+    switch (command) {
+        case MEM_TRACE_OFF:
+            mem_trace_active = false;
+            resume_after_dump = false;
+            break;
+        case MEM_TRACE_ON:
+            /* Clearing the buffer would overwrite the records being dumped */
+            if (records == NULL || dumping) {
+                interrupts_restore(flags);
+                return -1;
+            }
+            written = 0;
+            mem_trace_active = true;
+            break;
+        case MEM_TRACE_DUMP: {
+            if (records == NULL) {
+                interrupts_restore(flags);
+                return 0;
+            }
+            if (dumping) {
+                interrupts_restore(flags);
+                return -1;
+            }
+            /*
+             * Pausing recording is enough for a consistent cut: nothing writes
+             * the ring until it is re-armed, so the slow serial output can run
+             * with interrupts enabled.
+             */
+            dumping = true;
+            resume_after_dump = mem_trace_active;
+            mem_trace_active = false;
+            uint64_t end = written;
+            interrupts_restore(flags);
+
+            result = (int64_t)dump_records(end);
+
+            flags = interrupts_save_and_disable();
+            dumping = false;
+            if (resume_after_dump) {
+                mem_trace_active = true;
+            }
+            break;
+        }
+        default:
+            result = -1;
+            break;
+    }
+
+    interrupts_restore(flags);
+    return result;
+}
+
+int32_t mem_trace_get_info(mem_trace_info_t *info) {
+    if (info == NULL) {
+        return -1;
+    }
+
+    uint64_t flags = interrupts_save_and_disable();
+    info->active = mem_trace_active ? 1 : 0;
+    info->capacity = MEM_TRACE_RECORDS;
+    info->records = written < MEM_TRACE_RECORDS ? written : MEM_TRACE_RECORDS;
+    info->overwritten = written - info->records;
+    interrupts_restore(flags);
+    return 0;
+}
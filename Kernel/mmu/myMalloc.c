@@ -3,11 +3,11 @@
 #include <stddef.h>
 #include <stdint.h>
 #include <memoryManager.h>
+#include <memProfile.h>
+#include <frameAllocator.h>
 #include <interrupts.h>
 #include <lib.h>
 
-#define HEAP_SIZE (1u << 19)
-
 typedef struct Block {
     size_t size;
     int free;
@@ -16,34 +16,130 @@ typedef struct Block {
 
 #define BLOCK_SIZE sizeof(Block)
 
-static uint8_t heap[HEAP_SIZE];
+typedef struct Region {
+    uint8_t *start;
+    size_t size;
+} Region;
+
+/* Every contiguous run of frames becomes one initial block; blocks never span two */
+static Region regions[FRAME_REGION_MAX];
+static int region_count = 0;
+static size_t heap_size = 0;
+
 static Block *free_list = NULL;
 
+static size_t used_bytes = 0;
+static size_t free_bytes = 0;
+static size_t peak_used_bytes = 0;
+static size_t live_allocations = 0;
+static size_t free_counts[MEM_STATS_ORDERS];
+static size_t largest_free = 0;
+
+static int size_class(size_t size) {
+    int order = 0;
+    while (order < MEM_STATS_ORDERS - 1 && (size >> (order + 1)) != 0) {
+        order++;
+    }
+    return order;
+}
+
+static void account_free(size_t size) {
+    free_bytes += size;
+    free_counts[size_class(size)]++;
+    if (size > largest_free) {
+        largest_free = size;
+    }
+}
+
+static void account_taken(size_t size) {
+    free_bytes -= size;
+    free_counts[size_class(size)]--;
+}
+
+/* Only needed after the largest free block was handed out; mem_alloc is already a list walk */
+static void refresh_largest_free(void) {
+    largest_free = 0;
+    for (Block *curr = free_list; curr != NULL; curr = curr->next) {
+        if (curr->free && curr->size > largest_free) {
+            largest_free = curr->size;
+        }
+    }
+}
+
+static void regions_create(void) {
+    while (region_count < FRAME_REGION_MAX) {
+        size_t frames = frames_largest_run();
+        if (frames == 0) {
+            break;
+        }
+
+        regions[region_count].start = frames_alloc(frames);
+        regions[region_count].size = frames * FRAME_SIZE;
+        heap_size += regions[region_count].size;
+        region_count++;
+    }
+}
+
 void mem_init() {
     uint64_t flags = interrupts_save_and_disable();
-    free_list = (Block *) heap;
-    free_list->size = HEAP_SIZE - BLOCK_SIZE;
-    free_list->free = 1;
-    free_list->next = NULL;
+    /* Frames are handed out once; later calls only rebuild the block list */
+    if (region_count == 0) {
+        regions_create();
+    }
+
+    used_bytes = 0;
+    free_bytes = 0;
+    peak_used_bytes = 0;
+    live_allocations = 0;
+    largest_free = 0;
+    memset(free_counts, 0, sizeof(free_counts));
+
+    free_list = NULL;
+    for (int i = region_count - 1; i >= 0; i--) {
+        Block *block = (Block *) regions[i].start;
+        block->size = regions[i].size - BLOCK_SIZE;
+        block->free = 1;
+        block->next = free_list;
+        free_list = block;
+        account_free(block->size);
+    }
     interrupts_restore(flags);
 }
 
+/* Hands out curr, splitting off the tail when it can hold another header */
+static void *block_take(Block *curr, size_t size) {
+    int was_largest = curr->size == largest_free;
+    account_taken(curr->size);
+    if (curr->size > size + BLOCK_SIZE) {
+        Block *new_block = (Block *)((uint8_t *)curr + BLOCK_SIZE + size);
+        new_block->size = curr->size - size - BLOCK_SIZE;
+        new_block->free = 1;
+        new_block->next = curr->next;
+        curr->next = new_block;
+        curr->size = size;
+        account_free(new_block->size);
+    }
+    curr->free = 0;
+
+    used_bytes += curr->size;
+    if (used_bytes > peak_used_bytes) {
+        peak_used_bytes = used_bytes;
+    }
+    live_allocations++;
+    if (was_largest) {
+        refresh_largest_free();
+    }
+    return (uint8_t *)curr + BLOCK_SIZE;
+}
+
 void *mem_alloc(size_t size) {
     uint64_t flags = interrupts_save_and_disable();
     Block *curr = free_list;
 
     while (curr) {
         if (curr->free && curr->size >= size) {
-            if (curr->size > size + BLOCK_SIZE) {
-                Block *new_block = (Block *)((uint8_t *)curr + BLOCK_SIZE + size);
-                new_block->size = curr->size - size - BLOCK_SIZE;
-                new_block->free = 1;
-                new_block->next = curr->next;
-                curr->next = new_block;
-                curr->size = size;
-            }
-            curr->free = 0;
-            void *result = (uint8_t *)curr + BLOCK_SIZE;
+            void *result = block_take(curr, size);
+            MEM_PROFILE_ALLOC(result, size);
             interrupts_restore(flags);
             return result;
         }
@@ -54,6 +150,66 @@ void *mem_alloc(size_t size) {
     return NULL;
 }
 
+/*
+ * First fit on blocks that still hold size bytes past the first aligned
+ * address. The bytes skipped in front stay behind as a free block of their
+ * own, so the gap has to fit a header or be empty.
+ */
+void *mem_alloc_aligned(size_t size, size_t align) {
+    if (align == 0 || (align & (align - 1)) != 0) {
+        return NULL;
+    }
+
+    uint64_t flags = interrupts_save_and_disable();
+    Block *curr = free_list;
+
+    while (curr) {
+        if (curr->free) {
+            uintptr_t payload = (uintptr_t)curr + BLOCK_SIZE;
+            uintptr_t aligned = (payload + align - 1) & ~(uintptr_t)(align - 1);
+            while (aligned != payload && aligned - payload < BLOCK_SIZE) {
+                aligned += align;
+            }
+            size_t gap = aligned - payload;
+
+            if (curr->size >= gap && curr->size - gap >= size) {
+                if (gap != 0) {
+                    int was_largest = curr->size == largest_free;
+                    Block *aligned_block = (Block *)(aligned - BLOCK_SIZE);
+                    account_taken(curr->size);
+                    aligned_block->size = curr->size - gap;
+                    aligned_block->free = 1;
+                    aligned_block->next = curr->next;
+                    curr->size = gap - BLOCK_SIZE;
+                    curr->next = aligned_block;
+                    account_free(curr->size);
+                    account_free(aligned_block->size);
+                    if (was_largest) {
+                        refresh_largest_free();
+                    }
+                    curr = aligned_block;
+                }
+
+                void *result = block_take(curr, size);
+                MEM_PROFILE_ALLOC(result, size);
+                interrupts_restore(flags);
+                return result;
+            }
+        }
+        curr = curr->next;
+    }
+
+    interrupts_restore(flags);
+    return NULL;
+}
+
+void *mem_alloc_zeroed(size_t size) {
+    void *result = mem_alloc(size);
+    if (result != NULL) {
+        memzero(result, size);
+    }
+    return result;
+}
 
 void mem_free(void *ptr) {
     uint64_t flags = interrupts_save_and_disable();
@@ -63,30 +219,157 @@ void mem_free(void *ptr) {
     }
 
     Block *block = (Block *)((uint8_t *)ptr - BLOCK_SIZE);
+    if (block->free) {
+        interrupts_restore(flags);
+        return;
+    }
+
     block->free = 1;
+    used_bytes -= block->size;
+    live_allocations--;
+    account_free(block->size);
+    MEM_PROFILE_FREE(ptr);
+    interrupts_restore(flags);
+}
+
+void mem_free_sized(void *ptr, size_t size) {
+    (void) size;
+    mem_free(ptr);
+}
+
+static int blocks_adjacent(const Block *left, const Block *right) {
+    return right != NULL && (const uint8_t *)left + BLOCK_SIZE + left->size == (const uint8_t *)right;
+}
+
+/* Cuts a used block down to size, turning the tail into a free block */
+static void block_shrink(Block *curr, size_t size) {
+    if (curr->size <= size + BLOCK_SIZE) {
+        return;
+    }
+
+    Block *tail = (Block *)((uint8_t *)curr + BLOCK_SIZE + size);
+    tail->size = curr->size - size - BLOCK_SIZE;
+    tail->free = 1;
+    tail->next = curr->next;
+    curr->next = tail;
+    used_bytes -= curr->size - size;
+    curr->size = size;
+    account_free(tail->size);
+}
+
+/*
+ * Grows a used block by swallowing the free blocks physically after it,
+ * which is the only coalescing this allocator does. Returns 0, without
+ * touching anything, when they do not add up to size.
+ */
+static int block_grow(Block *curr, size_t size) {
+    size_t available = curr->size;
+    Block *last = curr;
+    while (available < size && blocks_adjacent(last, last->next) && last->next->free) {
+        last = last->next;
+        available += BLOCK_SIZE + last->size;
+    }
+    if (available < size) {
+        return 0;
+    }
+
+    int took_largest = 0;
+    while (curr->next != last->next) {
+        Block *next = curr->next;
+        took_largest |= next->size == largest_free;
+        account_taken(next->size);
+        used_bytes += BLOCK_SIZE + next->size;
+        curr->size += BLOCK_SIZE + next->size;
+        curr->next = next->next;
+    }
+    if (used_bytes > peak_used_bytes) {
+        peak_used_bytes = used_bytes;
+    }
+
+    block_shrink(curr, size);
+    if (took_largest) {
+        refresh_largest_free();
+    }
+    return 1;
+}
+
+void *mem_realloc(void *ptr, size_t size) {
+    if (ptr == NULL) {
+        return mem_alloc(size);
+    }
+    if (size == 0) {
+        mem_free(ptr);
+        return NULL;
+    }
+
+    uint64_t flags = interrupts_save_and_disable();
+    Block *block = (Block *)((uint8_t *)ptr - BLOCK_SIZE);
+    void *result = NULL;
+    if (block->free) {
+        interrupts_restore(flags);
+        return NULL;
+    }
+    MEM_PROFILE_REALLOC_BEGIN(ptr);
+
+    if (size <= block->size) {
+        block_shrink(block, size);
+        result = ptr;
+    } else if (block_grow(block, size)) {
+        result = ptr;
+    }
+    if (result != NULL) {
+        MEM_PROFILE_FREE(ptr);
+        MEM_PROFILE_ALLOC(ptr, size);
+        MEM_PROFILE_REALLOC_END();
+        interrupts_restore(flags);
+        return result;
+    }
+
+    result = mem_alloc(size);
+    if (result != NULL) {
+        memcpy(result, ptr, block->size);
+        mem_free(ptr);
+    }
+    MEM_PROFILE_REALLOC_END();
     interrupts_restore(flags);
+    return result;
+}
+
+size_t mem_usable_size(void *ptr) {
+    if (!ptr) {
+        return 0;
+    }
+
+    Block *block = (Block *)((uint8_t *)ptr - BLOCK_SIZE);
+    return block->free ? 0 : block->size;
 }
 
 void mem_status(size_t *total, size_t *used, size_t *available) {
     uint64_t flags = interrupts_save_and_disable();
-    *total = HEAP_SIZE;
-    *used = 0;
-    *available = 0;
+    *total = heap_size;
+    *used = used_bytes;
+    *available = free_bytes;
+    interrupts_restore(flags);
+}
 
-    Block *curr = free_list;
-    while (curr) {
-        if (curr->free) {
-            *available += curr->size;
-        } else {
-            *used += curr->size;
-        }
-        curr = curr->next;
+void mem_get_stats(mem_stats_t *stats) {
+    if (stats == NULL) {
+        return;
     }
+
+    uint64_t flags = interrupts_save_and_disable();
+    stats->total = heap_size;
+    stats->used = used_bytes;
+    stats->free = free_bytes;
+    stats->peak_used = peak_used_bytes;
+    stats->largest_free = largest_free;
+    stats->allocations = live_allocations;
+    memcpy(stats->free_blocks, free_counts, sizeof(free_counts));
     interrupts_restore(flags);
 }
 
 int32_t print_mem_status(void) {
-    size_t total = 0, used = 0, available = 0;
-    mem_status(&total, &used, &available);
-    return print_mem_status_common(total, used, available);
+    mem_stats_t stats;
+    mem_get_stats(&stats);
+    return print_mem_status_common(&stats);
 }
@@ -0,0 +1,238 @@
+// This is a personal academic project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+#include <stddef.h>
+#include <stdint.h>
+#include <slab.h>
+#include <memoryManager.h>
+#include <interrupts.h>
+#include <lib.h>
+
+#define OBJECT_ALIGN 8
+
+/*
+ * Every slab is a SLAB_SIZE-aligned chunk that starts with this header and is
+ * followed by objects_per_slab objects. Free objects are chained through
+ * their first word, so finding an object's slab is a single mask.
+ */
+typedef struct slab {
+    kmem_cache_t *cache;
+    struct slab *prev;
+    struct slab *next;
+    void *free_objects;
+    uint32_t in_use;
+} slab_t;
+
+typedef struct free_object {
+    struct free_object *next;
+} free_object_t;
+
+struct kmem_cache {
+    char name[KMEM_CACHE_NAME_MAX];
+    size_t object_size;
+    mem_tag_t tag;
+    uint32_t objects_per_slab;
+    /* Slabs with at least one free and one used object, allocated first */
+    slab_t *partial;
+    slab_t *full;
+    /* At most one completely free slab is kept around to absorb alloc/free churn */
+    slab_t *empty;
+    uint32_t slabs;
+    uint32_t partial_slabs;
+    uint32_t active_objects;
+    uint64_t allocations;
+    uint64_t frees;
+};
+
+static kmem_cache_t caches[KMEM_CACHE_MAX];
+static uint32_t cache_count = 0;
+
+static size_t slab_header_size(void) {
+    return (sizeof(slab_t) + OBJECT_ALIGN - 1) & ~(size_t)(OBJECT_ALIGN - 1);
+}
+
+static slab_t *slab_of(const void *object) {
+    return (slab_t *)((uintptr_t)object & ~(uintptr_t)(SLAB_SIZE - 1));
+}
+
+static void slab_list_push(slab_t **head, slab_t *slab) {
+    slab->prev = NULL;
+    slab->next = *head;
+    if (*head != NULL) {
+        (*head)->prev = slab;
+    }
+    *head = slab;
+}
+
+static void slab_list_remove(slab_t **head, slab_t *slab) {
+    if (slab->prev != NULL) {
+        slab->prev->next = slab->next;
+    } else {
+        *head = slab->next;
+    }
+    if (slab->next != NULL) {
+        slab->next->prev = slab->prev;
+    }
+    slab->prev = NULL;
+    slab->next = NULL;
+}
+
+static slab_t *slab_create(kmem_cache_t *cache) {
+    slab_t *slab = mem_alloc_aligned_tagged(SLAB_SIZE, SLAB_SIZE, cache->tag);
+    if (slab == NULL) {
+        return NULL;
+    }
+
+    slab->cache = cache;
+    slab->prev = NULL;
+    slab->next = NULL;
+    slab->in_use = 0;
+    slab->free_objects = NULL;
+
+    uint8_t *objects = (uint8_t *)slab + slab_header_size();
+    for (uint32_t i = cache->objects_per_slab; i > 0; i--) {
+        free_object_t *object = (free_object_t *)(objects + (i - 1) * cache->object_size);
+        object->next = slab->free_objects;
+        slab->free_objects = object;
+    }
+
+    cache->slabs++;
+    return slab;
+}
+
+static void slab_destroy(kmem_cache_t *cache, slab_t *slab) {
+    cache->slabs--;
+    slab->cache = NULL;
+    mem_free(slab);
+}
+
+kmem_cache_t *kmem_cache_create(const char *name, size_t object_size, mem_tag_t tag) {
+    if (name == NULL || object_size == 0) {
+        return NULL;
+    }
+
+    object_size = (object_size + OBJECT_ALIGN - 1) & ~(size_t)(OBJECT_ALIGN - 1);
+    if (object_size < sizeof(free_object_t)) {
+        object_size = sizeof(free_object_t);
+    }
+    if (object_size > SLAB_SIZE - slab_header_size()) {
+        return NULL;
+    }
+
+    uint64_t flags = interrupts_save_and_disable();
+    if (cache_count >= KMEM_CACHE_MAX) {
+        interrupts_restore(flags);
+        return NULL;
+    }
+
+    kmem_cache_t *cache = &caches[cache_count++];
+    memset(cache, 0, sizeof(*cache));
+    for (int i = 0; i < KMEM_CACHE_NAME_MAX - 1 && name[i] != '\0'; i++) {
+        cache->name[i] = name[i];
+    }
+    cache->object_size = object_size;
+    cache->tag = tag;
+    cache->objects_per_slab = (uint32_t)((SLAB_SIZE - slab_header_size()) / object_size);
+    interrupts_restore(flags);
+    return cache;
+}
+
+void *kmem_cache_alloc(kmem_cache_t *cache) {
+    if (cache == NULL) {
+        return NULL;
+    }
+
+    uint64_t flags = interrupts_save_and_disable();
+    slab_t *slab = cache->partial;
+
+    if (slab == NULL) {
+        slab = cache->empty;
+        if (slab != NULL) {
+            cache->empty = NULL;
+        } else {
+            slab = slab_create(cache);
+            if (slab == NULL) {
+                interrupts_restore(flags);
+                return NULL;
+            }
+        }
+        slab_list_push(&cache->partial, slab);
+        cache->partial_slabs++;
+    }
+
+    free_object_t *object = slab->free_objects;
+    slab->free_objects = object->next;
+    slab->in_use++;
+
+    if (slab->free_objects == NULL) {
+        slab_list_remove(&cache->partial, slab);
+        cache->partial_slabs--;
+        slab_list_push(&cache->full, slab);
+    }
+
+    cache->active_objects++;
+    cache->allocations++;
+    interrupts_restore(flags);
+    return object;
+}
+
+void kmem_cache_free(kmem_cache_t *cache, void *object) {
+    if (cache == NULL || object == NULL) {
+        return;
+    }
+
+    uint64_t flags = interrupts_save_and_disable();
+    slab_t *slab = slab_of(object);
+    if (slab->cache != cache || slab->in_use == 0) {
+        interrupts_restore(flags);
+        return;
+    }
+
+    if (slab->free_objects == NULL) {
+        slab_list_remove(&cache->full, slab);
+        slab_list_push(&cache->partial, slab);
+        cache->partial_slabs++;
+    }
+
+    free_object_t *freed = object;
+    freed->next = slab->free_objects;
+    slab->free_objects = freed;
+    slab->in_use--;
+
+    if (slab->in_use == 0) {
+        slab_list_remove(&cache->partial, slab);
+        cache->partial_slabs--;
+        if (cache->empty == NULL) {
+            cache->empty = slab;
+        } else {
+            slab_destroy(cache, slab);
+        }
+    }
+
+    cache->active_objects--;
+    cache->frees++;
+    interrupts_restore(flags);
+}
+
+int32_t kmem_cache_snapshot(kmem_cache_info_t *buffer, uint32_t capacity) {
+    if (buffer == NULL) {
+        return -1;
+    }
+
+    uint64_t flags = interrupts_save_and_disable();
+    uint32_t count = 0;
+    for (; count < cache_count && count < capacity; count++) {
+        kmem_cache_t *cache = &caches[count];
+        kmem_cache_info_t *info = &buffer[count];
+        memcpy(info->name, cache->name, KMEM_CACHE_NAME_MAX);
+        info->object_size = (uint32_t)cache->object_size;
+        info->objects_per_slab = cache->objects_per_slab;
+        info->slabs = cache->slabs;
+        info->partial_slabs = cache->partial_slabs;
+        info->active_objects = cache->active_objects;
+        info->total_objects = cache->slabs * cache->objects_per_slab;
+        info->allocations = cache->allocations;
+        info->frees = cache->frees;
+    }
+    interrupts_restore(flags);
+    return (int32_t)count;
+}
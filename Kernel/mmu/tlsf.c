@@ -0,0 +1,580 @@
+// This is a personal academic project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+#include <stddef.h>
+#include <stdint.h>
+#include <memoryManager.h>
+#include <memProfile.h>
+#include <frameAllocator.h>
+#include <interrupts.h>
+#include <lib.h>
+
+/*
+ * Two-Level Segregated Fit: free blocks are kept in lists indexed by a first
+ * level (power of two of the size) and a second level (SL_INDEX_COUNT linear
+ * steps inside it). Two bitmaps find the first non-empty list that can hold a
+ * request with a couple of bit scans, so mem_alloc and mem_free run in
+ * bounded time whatever the heap looks like.
+ */
+#define ALIGN_SIZE_LOG2 3
+#define ALIGN_SIZE (1u << ALIGN_SIZE_LOG2)
+#define SL_INDEX_COUNT_LOG2 4
+#define SL_INDEX_COUNT (1u << SL_INDEX_COUNT_LOG2)
+#define FL_INDEX_MAX 32
+#define FL_INDEX_SHIFT (SL_INDEX_COUNT_LOG2 + ALIGN_SIZE_LOG2)
+#define FL_INDEX_COUNT (FL_INDEX_MAX - FL_INDEX_SHIFT + 1)
+#define SMALL_BLOCK_SIZE (1u << FL_INDEX_SHIFT)
+
+#define BLOCK_FREE ((size_t)1u)
+#define BLOCK_SIZE_MASK (~(size_t)(ALIGN_SIZE - 1))
+
+#define POOL_MAX FRAME_REGION_MAX
+
+/*
+ * Every block starts with a pointer to the block physically before it and its
+ * payload size; the low bit of size marks it free. Free blocks keep their list
+ * links at the start of the payload.
+ */
+typedef struct Block {
+    struct Block *prev_phys;
+    size_t size;
+    struct Block *next_free;
+    struct Block *prev_free;
+} Block;
+
+#define BLOCK_OVERHEAD offsetof(Block, next_free)
+#define BLOCK_SIZE_MIN (sizeof(Block) - BLOCK_OVERHEAD)
+#define BLOCK_SIZE_MAX (((size_t)1u << FL_INDEX_MAX) - ALIGN_SIZE)
+
+typedef struct Pool {
+    uint8_t *start;
+    size_t size;
+} Pool;
+
+static uint64_t fl_bitmap = 0;
+static uint32_t sl_bitmap[FL_INDEX_COUNT];
+static Block *blocks[FL_INDEX_COUNT][SL_INDEX_COUNT];
+
+static Pool pools[POOL_MAX];
+static int pool_count = 0;
+static int initialized = 0;
+
+static size_t total_bytes = 0;
+static size_t used_bytes = 0;
+static size_t free_bytes = 0;
+static size_t peak_used_bytes = 0;
+static size_t live_allocations = 0;
+static size_t free_counts[MEM_STATS_ORDERS];
+
+static int find_first_set(uint64_t word) {
+    return __builtin_ctzll(word);
+}
+
+static int find_last_set(uint64_t word) {
+    return 63 - __builtin_clzll(word);
+}
+
+static size_t block_size(const Block *block) {
+    return block->size & BLOCK_SIZE_MASK;
+}
+
+static int block_is_free(const Block *block) {
+    return (block->size & BLOCK_FREE) != 0;
+}
+
+static void *block_payload(Block *block) {
+    return (uint8_t *)block + BLOCK_OVERHEAD;
+}
+
+static Block *block_of(void *ptr) {
+    return (Block *)((uint8_t *)ptr - BLOCK_OVERHEAD);
+}
+
+static Block *block_next(Block *block) {
+    return (Block *)((uint8_t *)block_payload(block) + block_size(block));
+}
+
+static int size_class(size_t size) {
+    int order = find_last_set(size);
+    return order < MEM_STATS_ORDERS ? order : MEM_STATS_ORDERS - 1;
+}
+
+static void mapping_insert(size_t size, int *fl, int *sl) {
+    if (size < SMALL_BLOCK_SIZE) {
+        *fl = 0;
+        *sl = (int)(size / (SMALL_BLOCK_SIZE / SL_INDEX_COUNT));
+    } else {
+        int last = find_last_set(size);
+        *sl = (int)((size >> (last - SL_INDEX_COUNT_LOG2)) ^ SL_INDEX_COUNT);
+        *fl = last - (FL_INDEX_SHIFT - 1);
+    }
+}
+
+/* Rounds the request up to the next list start so any block found there fits */
+static void mapping_search(size_t size, int *fl, int *sl) {
+    if (size >= SMALL_BLOCK_SIZE) {
+        size += ((size_t)1u << (find_last_set(size) - SL_INDEX_COUNT_LOG2)) - 1;
+    }
+    mapping_insert(size, fl, sl);
+}
+
+static Block *search_suitable_block(int *fl, int *sl) {
+    uint32_t sl_map = sl_bitmap[*fl] & (~0u << *sl);
+
+    if (sl_map == 0) {
+        uint64_t fl_map = fl_bitmap & (~(uint64_t)0 << (*fl + 1));
+        if (fl_map == 0) {
+            return NULL;
+        }
+        *fl = find_first_set(fl_map);
+        sl_map = sl_bitmap[*fl];
+    }
+
+    *sl = find_first_set(sl_map);
+    return blocks[*fl][*sl];
+}
+
+static void free_list_insert(Block *block) {
+    int fl, sl;
+    mapping_insert(block_size(block), &fl, &sl);
+
+    Block *head = blocks[fl][sl];
+    block->prev_free = NULL;
+    block->next_free = head;
+    if (head != NULL) {
+        head->prev_free = block;
+    }
+    blocks[fl][sl] = block;
+    fl_bitmap |= (uint64_t)1u << fl;
+    sl_bitmap[fl] |= 1u << sl;
+
+    block->size |= BLOCK_FREE;
+    free_bytes += block_size(block);
+    free_counts[size_class(block_size(block))]++;
+}
+
+static void free_list_remove(Block *block) {
+    int fl, sl;
+    mapping_insert(block_size(block), &fl, &sl);
+
+    if (block->prev_free != NULL) {
+        block->prev_free->next_free = block->next_free;
+    } else {
+        blocks[fl][sl] = block->next_free;
+        if (blocks[fl][sl] == NULL) {
+            sl_bitmap[fl] &= ~(1u << sl);
+            if (sl_bitmap[fl] == 0) {
+                fl_bitmap &= ~((uint64_t)1u << fl);
+            }
+        }
+    }
+    if (block->next_free != NULL) {
+        block->next_free->prev_free = block->prev_free;
+    }
+
+    block->size &= ~BLOCK_FREE;
+    free_bytes -= block_size(block);
+    free_counts[size_class(block_size(block))]--;
+}
+
+/* Cuts block down to size and returns the tail to the free lists */
+static void block_trim(Block *block, size_t size) {
+    if (block_size(block) < size + sizeof(Block)) {
+        return;
+    }
+
+    Block *rest = (Block *)((uint8_t *)block_payload(block) + size);
+    rest->size = block_size(block) - size - BLOCK_OVERHEAD;
+    rest->prev_phys = block;
+    block->size = size | (block->size & BLOCK_FREE);
+    block_next(rest)->prev_phys = rest;
+    free_list_insert(rest);
+}
+
+static Block *block_merge(Block *left, Block *right) {
+    left->size += block_size(right) + BLOCK_OVERHEAD;
+    /* Leave the swallowed header looking free so an immediate double free is ignored */
+    right->size |= BLOCK_FREE;
+    block_next(left)->prev_phys = left;
+    return left;
+}
+
+static int pool_contains(const void *ptr) {
+    for (int i = 0; i < pool_count; i++) {
+        if ((const uint8_t *)ptr >= pools[i].start + BLOCK_OVERHEAD && (const uint8_t *)ptr < pools[i].start + pools[i].size) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/* One free block spanning the pool followed by a zero-sized used sentinel */
+static void pool_reset(const Pool *pool) {
+    Block *block = (Block *)pool->start;
+    block->prev_phys = NULL;
+    block->size = pool->size - 2 * BLOCK_OVERHEAD;
+
+    Block *sentinel = block_next(block);
+    sentinel->prev_phys = block;
+    sentinel->size = 0;
+
+    free_list_insert(block);
+}
+
+static void pools_create(void) {
+    size_t frames_max = (BLOCK_SIZE_MAX & ~((size_t)FRAME_SIZE - 1)) / FRAME_SIZE;
+
+    while (pool_count < POOL_MAX) {
+        size_t frames = frames_largest_run();
+        if (frames == 0) {
+            break;
+        }
+        if (frames > frames_max) {
+            frames = frames_max;
+        }
+
+        pools[pool_count].start = frames_alloc(frames);
+        pools[pool_count].size = frames * FRAME_SIZE;
+        total_bytes += pools[pool_count].size;
+        pool_count++;
+    }
+}
+
+void mem_init(void) {
+    uint64_t flags = interrupts_save_and_disable();
+    /* Frames are handed out once; later calls only rebuild the pools already taken */
+    if (pool_count == 0) {
+        pools_create();
+    }
+
+    fl_bitmap = 0;
+    memset(sl_bitmap, 0, sizeof(sl_bitmap));
+    memset(blocks, 0, sizeof(blocks));
+    memset(free_counts, 0, sizeof(free_counts));
+    used_bytes = 0;
+    free_bytes = 0;
+    peak_used_bytes = 0;
+    live_allocations = 0;
+
+    for (int i = 0; i < pool_count; i++) {
+        pool_reset(&pools[i]);
+    }
+    initialized = 1;
+    interrupts_restore(flags);
+}
+
+static size_t adjust_request(size_t size) {
+    size = (size + ALIGN_SIZE - 1) & BLOCK_SIZE_MASK;
+    return size < BLOCK_SIZE_MIN ? BLOCK_SIZE_MIN : size;
+}
+
+/* Finds and unlinks a free block of at least size bytes, or returns NULL */
+static Block *take_free_block(size_t size) {
+    int fl, sl;
+    mapping_search(size, &fl, &sl);
+    if (fl >= FL_INDEX_COUNT) {
+        return NULL;
+    }
+
+    Block *block = search_suitable_block(&fl, &sl);
+    if (block != NULL) {
+        free_list_remove(block);
+    }
+    return block;
+}
+
+static void *block_use(Block *block, size_t size) {
+    block_trim(block, size);
+    used_bytes += block_size(block);
+    if (used_bytes > peak_used_bytes) {
+        peak_used_bytes = used_bytes;
+    }
+    live_allocations++;
+    return block_payload(block);
+}
+
+/* Gives the first gap bytes of a free block back as a block of their own */
+static Block *block_trim_leading(Block *block, size_t gap) {
+    Block *rest = (Block *)((uint8_t *)block + gap);
+    rest->size = block_size(block) - gap;
+    rest->prev_phys = block;
+    block->size = gap - BLOCK_OVERHEAD;
+    block_next(rest)->prev_phys = rest;
+    free_list_insert(block);
+    return rest;
+}
+
+void *mem_alloc(size_t size) {
+    uint64_t flags = interrupts_save_and_disable();
+    void *result = NULL;
+
+    if (!initialized) {
+        mem_init();
+    }
+
+    if (size == 0 || size > BLOCK_SIZE_MAX) {
+        goto out;
+    }
+
+    size_t adjusted = adjust_request(size);
+    Block *block = take_free_block(adjusted);
+    if (block == NULL) {
+        goto out;
+    }
+
+    result = block_use(block, adjusted);
+    MEM_PROFILE_ALLOC(result, size);
+
+out:
+    interrupts_restore(flags);
+    return result;
+}
+
+/*
+ * Asks the lists for enough room to slide the payload up to the next aligned
+ * address. The skipped bytes become a free block, so a gap too small to hold
+ * one is widened by another align step first.
+ */
+void *mem_alloc_aligned(size_t size, size_t align) {
+    if (align == 0 || (align & (align - 1)) != 0) {
+        return NULL;
+    }
+    if (align <= ALIGN_SIZE) {
+        return mem_alloc(size);
+    }
+
+    uint64_t flags = interrupts_save_and_disable();
+    void *result = NULL;
+
+    if (!initialized) {
+        mem_init();
+    }
+
+    if (size == 0 || size > BLOCK_SIZE_MAX || align > BLOCK_SIZE_MAX - size) {
+        goto out;
+    }
+
+    size_t adjusted = adjust_request(size);
+    size_t slack = align + sizeof(Block);
+    if (adjusted > BLOCK_SIZE_MAX - slack) {
+        goto out;
+    }
+
+    Block *block = take_free_block(adjusted + slack);
+    if (block == NULL) {
+        goto out;
+    }
+
+    uintptr_t payload = (uintptr_t)block_payload(block);
+    uintptr_t aligned = (payload + align - 1) & ~(uintptr_t)(align - 1);
+    while (aligned != payload && aligned - payload < sizeof(Block)) {
+        aligned += align;
+    }
+    if (aligned != payload) {
+        block = block_trim_leading(block, aligned - payload);
+    }
+
+    result = block_use(block, adjusted);
+    MEM_PROFILE_ALLOC(result, size);
+
+out:
+    interrupts_restore(flags);
+    return result;
+}
+
+void *mem_alloc_zeroed(size_t size) {
+    void *result = mem_alloc(size);
+    if (result != NULL) {
+        memzero(result, size);
+    }
+    return result;
+}
+
+void mem_free(void *ptr) {
+    if (ptr == NULL) {
+        return;
+    }
+
+    uint64_t flags = interrupts_save_and_disable();
+    if (!initialized || ((uintptr_t)ptr & (ALIGN_SIZE - 1)) != 0 || !pool_contains(ptr)) {
+        interrupts_restore(flags);
+        return;
+    }
+
+    Block *block = block_of(ptr);
+    if (block_is_free(block) || block_size(block) == 0) {
+        interrupts_restore(flags);
+        return;
+    }
+
+    used_bytes -= block_size(block);
+    live_allocations--;
+    MEM_PROFILE_FREE(ptr);
+
+    /* Coalesce right away with whichever physical neighbours are free */
+    Block *prev = block->prev_phys;
+    if (prev != NULL && block_is_free(prev)) {
+        free_list_remove(prev);
+        block = block_merge(prev, block);
+    }
+
+    Block *next = block_next(block);
+    if (block_is_free(next)) {
+        free_list_remove(next);
+        block = block_merge(block, next);
+    }
+
+    free_list_insert(block);
+    interrupts_restore(flags);
+}
+
+void mem_free_sized(void *ptr, size_t size) {
+    (void) size;
+    mem_free(ptr);
+}
+
+/* Cuts a used block down to size; the tail merges with a free block after it */
+static void block_shrink(Block *block, size_t size) {
+    if (block_size(block) < size + sizeof(Block)) {
+        return;
+    }
+
+    used_bytes -= block_size(block) - size;
+    Block *rest = (Block *)((uint8_t *)block_payload(block) + size);
+    rest->size = block_size(block) - size - BLOCK_OVERHEAD;
+    rest->prev_phys = block;
+    block->size = size;
+    block_next(rest)->prev_phys = rest;
+
+    Block *next = block_next(rest);
+    if (block_is_free(next)) {
+        free_list_remove(next);
+        rest = block_merge(rest, next);
+    }
+    free_list_insert(rest);
+}
+
+void *mem_realloc(void *ptr, size_t size) {
+    if (ptr == NULL) {
+        return mem_alloc(size);
+    }
+    if (size == 0) {
+        mem_free(ptr);
+        return NULL;
+    }
+
+    uint64_t flags = interrupts_save_and_disable();
+    void *result = NULL;
+    if (!initialized || ((uintptr_t)ptr & (ALIGN_SIZE - 1)) != 0 || !pool_contains(ptr) || size > BLOCK_SIZE_MAX) {
+        goto out;
+    }
+
+    Block *block = block_of(ptr);
+    if (block_is_free(block) || block_size(block) == 0) {
+        goto out;
+    }
+    MEM_PROFILE_REALLOC_BEGIN(ptr);
+
+    size_t adjusted = adjust_request(size);
+    size_t current = block_size(block);
+    Block *next = block_next(block);
+    if (adjusted > current && block_is_free(next) && current + BLOCK_OVERHEAD + block_size(next) >= adjusted) {
+        free_list_remove(next);
+        block_merge(block, next);
+        used_bytes += block_size(block) - current;
+        if (used_bytes > peak_used_bytes) {
+            peak_used_bytes = used_bytes;
+        }
+    }
+
+    if (adjusted <= block_size(block)) {
+        block_shrink(block, adjusted);
+        MEM_PROFILE_FREE(ptr);
+        MEM_PROFILE_ALLOC(ptr, size);
+        MEM_PROFILE_REALLOC_END();
+        result = ptr;
+        goto out;
+    }
+
+    result = mem_alloc(size);
+    if (result != NULL) {
+        memcpy(result, ptr, current);
+        mem_free(ptr);
+    }
+    MEM_PROFILE_REALLOC_END();
+
+out:
+    interrupts_restore(flags);
+    return result;
+}
+
+size_t mem_usable_size(void *ptr) {
+    if (ptr == NULL || !initialized) {
+        return 0;
+    }
+
+    uint64_t flags = interrupts_save_and_disable();
+    size_t size = 0;
+    if (pool_contains(ptr)) {
+        Block *block = block_of(ptr);
+        size = block_is_free(block) ? 0 : block_size(block);
+    }
+    interrupts_restore(flags);
+    return size;
+}
+
+void mem_status(size_t *total, size_t *used, size_t *available) {
+    uint64_t flags = interrupts_save_and_disable();
+    if (!initialized) {
+        mem_init();
+    }
+
+    if (total != NULL) {
+        *total = total_bytes;
+    }
+
+    if (used != NULL) {
+        *used = used_bytes;
+    }
+
+    if (available != NULL) {
+        *available = free_bytes;
+    }
+    interrupts_restore(flags);
+}
+
+void mem_get_stats(mem_stats_t *stats) {
+    if (stats == NULL) {
+        return;
+    }
+
+    uint64_t flags = interrupts_save_and_disable();
+    if (!initialized) {
+        mem_init();
+    }
+
+    stats->total = total_bytes;
+    stats->used = used_bytes;
+    stats->free = free_bytes;
+    stats->peak_used = peak_used_bytes;
+    stats->allocations = live_allocations;
+    memcpy(stats->free_blocks, free_counts, sizeof(free_counts));
+
+    /* The largest block sits in the highest non-empty list, which rarely holds more than one */
+    stats->largest_free = 0;
+    if (fl_bitmap != 0) {
+        int fl = find_last_set(fl_bitmap);
+        int sl = find_last_set(sl_bitmap[fl]);
+        for (Block *it = blocks[fl][sl]; it != NULL; it = it->next_free) {
+            if (block_size(it) > stats->largest_free) {
+                stats->largest_free = block_size(it);
+            }
+        }
+    }
+    interrupts_restore(flags);
+}
+
+int32_t print_mem_status(void) {
+    mem_stats_t stats;
+    mem_get_stats(&stats);
+    return print_mem_status_common(&stats);
+}
@@ -1,98 +1,193 @@
 // This is a personal academic project. Dear PVS-Studio, please check it.
 // PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
 #include <pipes.h>
-#include <sem.h>
 #include <string.h>
+#include <lib.h>
 #include <memoryManager.h>
+#include <slab.h>
 #include <process.h>
+#include <scheduler.h>
+#include <interrupts.h>
+#include <waitQueue.h>
+#include <sem.h>
+#include <time.h>
 
-#define SEM_NAME_LENGTH 9
 #define NEXT_PIPE_ID(pipe) ((pipe)->id + 1) % MAX_PIPES
 #define PREV_PIPE_ID(pipe) ((pipe)->id - 1 + MAX_PIPES) % MAX_PIPES
-#define NEXT_BUFFER_IDX(idx) (((idx) + 1) % PIPE_BUFFER_SIZE)
+
+#define IS_STD_PIPE(id) ((id) == STDIN || (id) == STDOUT || (id) == STDERR)
+
+/*
+ * The ring is indexed by free-running byte counts: only the reader advances
+ * read_pos and only the writer advances write_pos, each publishing with a
+ * release store after copying, so one reader and one writer never need a
+ * lock between them. Same-side peers are kept apart by a claim on the
+ * reader or writer slot, which holds the pid of the process moving data on
+ * that side; for the usual `a | b` pipe that claim is a single uncontended
+ * compare-and-swap and interrupts stay enabled during the copy.
+ *
+ * Readers sleep on readers until there is data or no writer left; writers
+ * sleep on writers until there is room. Both queues also hold processes
+ * waiting for a slot, and every sleeper re-checks, so waking them all is
+ * safe. The terminal pipes are also written from the keyboard interrupt,
+ * which cannot claim anything, so they move data with interrupts disabled
+ * instead.
+ *
+ * The buffer is allocated on the first write with PIPE_BUFFER_SIZE bytes
+ * and doubles, up to capacity, when a writer finds it full; once a reader
+ * drains a grown buffer it is freed and the next write starts small again.
+ * Reallocating needs both slots, so it is only ever attempted with a
+ * compare-and-swap on the other side's slot and skipped when that fails.
+ * The terminal pipes get their buffer up front and never change it.
+ */
+
+/* Contention on one side of a pipe, reported by sem_snapshot next to the semaphores */
+typedef struct pipe_side_stats {
+	uint64_t transfers;
+	uint64_t blocked;
+	uint64_t blocked_ticks;
+	uint64_t max_blocked_ticks;
+} pipe_side_stats_t;
 
 struct pipe {
 	uint8_t id;
-	uint8_t buffer[PIPE_BUFFER_SIZE];
-	uint64_t read_idx;
-	uint64_t write_idx;
-	uint64_t data_count;
-	sem_t *can_read;
-	sem_t *can_write;
-	sem_t *mutex;
+	uint8_t *buffer;
+	uint32_t size;
+	volatile uint32_t capacity;
+	volatile uint64_t read_pos;
+	volatile uint64_t write_pos;
+	volatile uint32_t reader;
+	volatile uint32_t writer;
+	wait_queue_t readers;
+	wait_queue_t writers;
+	pipe_side_stats_t read_stats;
+	pipe_side_stats_t write_stats;
 	uint8_t attached_count;
-	uint32_t waiting_readers;
-	uint32_t waiting_writers;
 };
 
 static pipe_t pipes[MAX_PIPES];
 static uint8_t next_pipe_id = 0;
-static char sem_name[SEM_NAME_LENGTH];
+static kmem_cache_t *pipe_cache = NULL;
 
 static void destroy_pipe(uint8_t id, pipe_t pipe);
 
 void init_pipes(void) {
-  strcpy(sem_name, "pipe_XXX");
-  sem_name[SEM_NAME_LENGTH - 1] = '\0';
+	if (pipe_cache == NULL) {
+		pipe_cache = kmem_cache_create("pipe", sizeof(struct pipe), MEM_TAG_PIPES);
+	}
 }
 
-static void set_sem_name_number(void) {
-	sem_name[5] = '0' + (next_pipe_id / 10);
-	sem_name[6] = '0' + (next_pipe_id % 10);
-}
+static pipe_t create_pipe(uint32_t capacity) {
+	init_pipes();
 
-static pipe_t create_pipe(void) {
-	pipe_t new_pipe = mem_alloc(sizeof(struct pipe));
+	pipe_t new_pipe = kmem_cache_alloc(pipe_cache);
 	if (new_pipe == NULL) {
 		return NULL;
 	}
 
 	new_pipe->id = next_pipe_id;
-	new_pipe->read_idx = 0;
-	new_pipe->write_idx = 0;
-	new_pipe->data_count = 0;
+	new_pipe->buffer = NULL;
+	new_pipe->size = 0;
+	new_pipe->capacity = capacity;
+	if (IS_STD_PIPE(next_pipe_id)) {
+		new_pipe->buffer = mem_alloc_tagged(PIPE_BUFFER_SIZE, MEM_TAG_PIPES);
+		if (new_pipe->buffer == NULL) {
+			kmem_cache_free(pipe_cache, new_pipe);
+			return NULL;
+		}
+		new_pipe->size = PIPE_BUFFER_SIZE;
+		new_pipe->capacity = PIPE_BUFFER_SIZE;
+	}
+	new_pipe->read_pos = 0;
+	new_pipe->write_pos = 0;
+	new_pipe->reader = 0;
+	new_pipe->writer = 0;
 	new_pipe->attached_count = 0;
-	new_pipe->waiting_readers = 0;
-	new_pipe->waiting_writers = 0;
+	wait_queue_init(&new_pipe->readers);
+	wait_queue_init(&new_pipe->writers);
+	memset(&new_pipe->read_stats, 0, sizeof(pipe_side_stats_t));
+	memset(&new_pipe->write_stats, 0, sizeof(pipe_side_stats_t));
 
-	set_sem_name_number();
+	return new_pipe;
+}
 
-	sem_name[7] = 'R';
-	new_pipe->can_read = sem_create();
-	if (new_pipe->can_read == NULL) {
-		mem_free(new_pipe);
-		return NULL;
-	}
-	sem_init(new_pipe->can_read, sem_name, 0);
+/* Read position first: a clear_pipe can only move it up to write_pos */
+static uint64_t pipe_used(pipe_t pipe) {
+	uint64_t read_pos = __atomic_load_n(&pipe->read_pos, __ATOMIC_ACQUIRE);
+	return __atomic_load_n(&pipe->write_pos, __ATOMIC_ACQUIRE) - read_pos;
+}
 
-	sem_name[7] = 'W';
-	new_pipe->can_write = sem_create();
-	if (new_pipe->can_write == NULL) {
-		sem_destroy(new_pipe->can_read);
-		mem_free(new_pipe);
-		return NULL;
+static bool can_read(void *context) {
+	pipe_t pipe = context;
+	return pipe_used(pipe) > 0 || pipe->attached_count <= 1;
+}
+
+/* Bytes the ring may hold right now: what is allocated, within the capacity */
+static uint64_t pipe_limit(pipe_t pipe) {
+	uint32_t capacity = pipe->capacity;
+	return pipe->size < capacity ? pipe->size : capacity;
+}
+
+static bool can_write(void *context) {
+	pipe_t pipe = context;
+	return pipe->buffer == NULL || pipe_used(pipe) < pipe_limit(pipe);
+}
+
+static uint32_t current_pid(void) {
+	process_t *current = scheduler_current();
+	return current == NULL ? 0 : current->pid;
+}
+
+static bool claim_slot(volatile uint32_t *slot) {
+	return __sync_bool_compare_and_swap(slot, 0, current_pid());
+}
+
+static bool claim_read(void *context) {
+	return claim_slot(&((pipe_t)context)->reader);
+}
+
+static bool claim_write(void *context) {
+	return claim_slot(&((pipe_t)context)->writer);
+}
+
+/*
+ * Wakes a side after the indices moved. The fence keeps the queue check
+ * after the index update; a sleeper checks its condition and enqueues with
+ * interrupts disabled, so it either sees the update or is already queued.
+ */
+static void wake_side(wait_queue_t *queue) {
+	__atomic_thread_fence(__ATOMIC_SEQ_CST);
+	if (queue->count > 0) {
+		wake_all(queue);
 	}
-	sem_init(new_pipe->can_write, sem_name, 0);
+}
 
-	sem_name[7] = 'M';
-	new_pipe->mutex = sem_create();
-	if (new_pipe->mutex == NULL) {
-		sem_destroy(new_pipe->can_read);
-		sem_destroy(new_pipe->can_write);
-		mem_free(new_pipe);
-		return NULL;
+/* Same accounting as the semaphores: a transfer that had to wait counts as blocked */
+static void record_transfer(pipe_side_stats_t *stats, bool waited, uint64_t start) {
+	uint64_t flags = interrupts_save_and_disable();
+	stats->transfers++;
+	if (waited) {
+		uint64_t blocked = (uint64_t)ticks_elapsed() - start;
+		stats->blocked++;
+		stats->blocked_ticks += blocked;
+		if (blocked > stats->max_blocked_ticks) {
+			stats->max_blocked_ticks = blocked;
+		}
 	}
-	sem_init(new_pipe->mutex, sem_name, 1);
+	interrupts_restore(flags);
+}
 
-	return new_pipe;
+static void release_slot(volatile uint32_t *slot, wait_queue_t *peers) {
+	__atomic_store_n(slot, 0, __ATOMIC_RELEASE);
+	wake_side(peers);
 }
 
-int open_pipe(void) {
-  if (next_pipe_id >= MAX_PIPES) {
+int open_pipe(uint32_t capacity) {
+  if (next_pipe_id >= MAX_PIPES || capacity > PIPE_MAX_CAPACITY) {
     return -1;
   }
 
-  pipe_t new_pipe = create_pipe();
+  pipe_t new_pipe = create_pipe(capacity == 0 ? PIPE_DEFAULT_CAPACITY : capacity);
   if (new_pipe == NULL) {
     return -1;
   }
@@ -108,61 +203,244 @@ int attach_to_pipe(uint8_t id) {
 
   pipe_t pipe = pipes[id];
 
-  sem_wait(pipe->mutex);
+  uint64_t flags = interrupts_save_and_disable();
   pipe->attached_count++;
-  sem_post(pipe->mutex);
+  interrupts_restore(flags);
 
   return 0;
 }
 
-int read_pipe(uint8_t id, uint8_t * buffer, uint64_t bytes) {
-	if (buffer == NULL) {
-		return -1;
+/* Copies up to count buffered bytes out in at most two spans; returns how many */
+static uint64_t ring_take(pipe_t pipe, uint8_t *dest, uint64_t count) {
+	uint64_t read_pos = __atomic_load_n(&pipe->read_pos, __ATOMIC_ACQUIRE);
+	uint64_t used = __atomic_load_n(&pipe->write_pos, __ATOMIC_ACQUIRE) - read_pos;
+	if (count > used) {
+		count = used;
+	}
+	/* Buffered data pins the buffer; with none it may be gone */
+	if (count == 0) {
+		return 0;
+	}
+	uint64_t offset = read_pos % pipe->size;
+	uint64_t first = pipe->size - offset;
+	if (first > count) {
+		first = count;
 	}
 
-	if (bytes == 0) {
+	memcpy(dest, pipe->buffer + offset, first);
+	memcpy(dest + first, pipe->buffer, count - first);
+	/* Fails only if clear_pipe ran meanwhile, and then its position stands */
+	__sync_bool_compare_and_swap(&pipe->read_pos, read_pos, read_pos + count);
+	return count;
+}
+
+/* Copies as much of count bytes as fits into the ring in at most two spans */
+static uint64_t ring_put(pipe_t pipe, const uint8_t *src, uint64_t count) {
+	uint64_t write_pos = pipe->write_pos;
+	uint64_t used = write_pos - __atomic_load_n(&pipe->read_pos, __ATOMIC_ACQUIRE);
+	uint64_t limit = pipe_limit(pipe);
+	uint64_t room = limit > used ? limit - used : 0;
+	if (count > room) {
+		count = room;
+	}
+	if (count == 0) {
 		return 0;
 	}
+	uint64_t offset = write_pos % pipe->size;
+	uint64_t first = pipe->size - offset;
+	if (first > count) {
+		first = count;
+	}
 
-	if (id >= MAX_PIPES || pipes[id] == NULL) {
-		return -1;
+	memcpy(pipe->buffer + offset, src, first);
+	memcpy(pipe->buffer, src + first, count - first);
+	__atomic_store_n(&pipe->write_pos, write_pos + count, __ATOMIC_RELEASE);
+	return count;
+}
+
+/* Called by the writer; the reader only looks at the buffer once data is published */
+static bool ensure_buffer(pipe_t pipe) {
+	if (pipe->buffer != NULL) {
+		return true;
+	}
+	uint32_t size = pipe->capacity < PIPE_BUFFER_SIZE ? pipe->capacity : PIPE_BUFFER_SIZE;
+	uint8_t *buffer = mem_alloc_tagged(size, MEM_TAG_PIPES);
+	if (buffer == NULL) {
+		return false;
 	}
+	pipe->buffer = buffer;
+	pipe->size = size;
+	return true;
+}
 
-	pipe_t pipe = pipes[id];
-	uint64_t read_bytes = 0;
-
-	while (read_bytes < bytes) {
-		sem_wait(pipe->mutex);
-		if (pipe->data_count == 0) {
-			if (pipe->attached_count <= 1) {
-				sem_post(pipe->mutex);
-				return 0;
-			}
-
-			pipe->waiting_readers++;
-			sem_post(pipe->mutex);
-
-			sem_wait(pipe->can_read);
-			sem_wait(pipe->mutex);
-			pipe->waiting_readers--;
-			sem_post(pipe->mutex);
-			continue;
+/* Called by the writer holding its slot when the ring is full */
+static bool grow_buffer(pipe_t pipe) {
+	if (pipe->size >= pipe->capacity || !claim_slot(&pipe->reader)) {
+		return false;
+	}
+
+	uint32_t size = pipe->size * 2 < pipe->capacity ? pipe->size * 2 : pipe->capacity;
+	uint8_t *buffer = mem_alloc_tagged(size, MEM_TAG_PIPES);
+	if (buffer == NULL) {
+		release_slot(&pipe->reader, &pipe->readers);
+		return false;
+	}
+
+	/* Unrolled to the start of the new ring; masked so clear_pipe cannot interleave */
+	uint64_t flags = interrupts_save_and_disable();
+	uint8_t *old_buffer = pipe->buffer;
+	uint32_t old_size = pipe->size;
+	uint64_t used = ring_take(pipe, buffer, size);
+	pipe->buffer = buffer;
+	pipe->size = size;
+	pipe->read_pos = 0;
+	pipe->write_pos = used;
+	interrupts_restore(flags);
+
+	mem_free_sized(old_buffer, old_size);
+	release_slot(&pipe->reader, &pipe->readers);
+	return true;
+}
+
+/* Called by the reader holding its slot after a read */
+static void shrink_if_drained(pipe_t pipe) {
+	if (pipe->size <= PIPE_BUFFER_SIZE && pipe->size <= pipe->capacity) {
+		return;
+	}
+	if (pipe_used(pipe) != 0 || !claim_slot(&pipe->writer)) {
+		return;
+	}
+
+	uint8_t *old_buffer = NULL;
+	uint32_t old_size = pipe->size;
+	if (pipe_used(pipe) == 0) {
+		old_buffer = pipe->buffer;
+		pipe->buffer = NULL;
+		pipe->size = 0;
+	}
+	release_slot(&pipe->writer, &pipe->writers);
+
+	if (old_buffer != NULL) {
+		mem_free_sized(old_buffer, old_size);
+	}
+}
+
+static int read_masked(pipe_t pipe, uint8_t *buffer, uint64_t bytes) {
+	uint64_t start = (uint64_t)ticks_elapsed();
+	bool waited = false;
+	uint64_t flags;
+	while (1) {
+		waited = waited || !can_read(pipe);
+		if (wait_event(&pipe->readers, can_read, pipe) != WAIT_WOKEN) {
+			return -1;
+		}
+		/* Another reader may have drained it since wait_event returned */
+		flags = interrupts_save_and_disable();
+		if (can_read(pipe)) {
+			break;
+		}
+		interrupts_restore(flags);
+	}
+
+	uint64_t read_bytes = ring_take(pipe, buffer, bytes);
+	if (read_bytes > 0) {
+		wake_side(&pipe->writers);
+	}
+	interrupts_restore(flags);
+
+	record_transfer(&pipe->read_stats, waited, start);
+	return (int)read_bytes;
+}
+
+static int write_masked(pipe_t pipe, const uint8_t *buffer, uint64_t bytes) {
+	uint64_t start = (uint64_t)ticks_elapsed();
+	bool waited = false;
+	uint64_t written_bytes = 0;
+
+	while (written_bytes < bytes) {
+		waited = waited || !can_write(pipe);
+		if (wait_event(&pipe->writers, can_write, pipe) != WAIT_WOKEN) {
+			return written_bytes > 0 ? (int)written_bytes : -1;
 		}
 
-		buffer[read_bytes] = pipe->buffer[pipe->read_idx];
-		pipe->read_idx = NEXT_BUFFER_IDX(pipe->read_idx);
-		pipe->data_count--;
+		uint64_t flags = interrupts_save_and_disable();
+		uint64_t chunk = ring_put(pipe, buffer + written_bytes, bytes - written_bytes);
+		if (chunk > 0) {
+			wake_side(&pipe->readers);
+		}
+		interrupts_restore(flags);
+
+		written_bytes += chunk;
+	}
 
-		sem_post(pipe->mutex);
-		sem_post(pipe->can_write);
+	record_transfer(&pipe->write_stats, waited, start);
+	return (int)written_bytes;
+}
 
-		read_bytes++;
+/* A WAIT_RELEASED pipe is already freed, so those paths leave without touching it */
+static int read_claimed(pipe_t pipe, uint8_t *buffer, uint64_t bytes) {
+	uint64_t start = (uint64_t)ticks_elapsed();
+	bool waited = !claim_slot(&pipe->reader);
+	if (waited && wait_event(&pipe->readers, claim_read, pipe) != WAIT_WOKEN) {
+		return -1;
 	}
 
+	uint64_t read_bytes;
+	while ((read_bytes = ring_take(pipe, buffer, bytes)) == 0 && pipe->attached_count > 1) {
+		waited = true;
+		if (wait_event(&pipe->readers, can_read, pipe) != WAIT_WOKEN) {
+			return -1;
+		}
+	}
+
+	record_transfer(&pipe->read_stats, waited, start);
+	shrink_if_drained(pipe);
+	release_slot(&pipe->reader, &pipe->readers);
+	if (read_bytes > 0) {
+		wake_side(&pipe->writers);
+	}
 	return (int)read_bytes;
 }
 
-int write_pipe(uint8_t id, const uint8_t * buffer, uint64_t bytes) {
+/* Keeps the writer slot for the whole call, so one write is never interleaved */
+static int write_claimed(pipe_t pipe, const uint8_t *buffer, uint64_t bytes) {
+	uint64_t start = (uint64_t)ticks_elapsed();
+	bool waited = !claim_slot(&pipe->writer);
+	if (waited && wait_event(&pipe->writers, claim_write, pipe) != WAIT_WOKEN) {
+		return -1;
+	}
+
+	uint64_t written_bytes = 0;
+	while (written_bytes < bytes) {
+		if (!ensure_buffer(pipe)) {
+			release_slot(&pipe->writer, &pipe->writers);
+			return written_bytes > 0 ? (int)written_bytes : -1;
+		}
+		uint64_t chunk = ring_put(pipe, buffer + written_bytes, bytes - written_bytes);
+		if (chunk > 0) {
+			written_bytes += chunk;
+			wake_side(&pipe->readers);
+			continue;
+		}
+		if (grow_buffer(pipe)) {
+			continue;
+		}
+		waited = true;
+		if (wait_event(&pipe->writers, can_write, pipe) != WAIT_WOKEN) {
+			return written_bytes > 0 ? (int)written_bytes : -1;
+		}
+	}
+
+	record_transfer(&pipe->write_stats, waited, start);
+	release_slot(&pipe->writer, &pipe->writers);
+	return (int)written_bytes;
+}
+
+/*
+ * Returns whatever is buffered, up to bytes, blocking only while the pipe
+ * is empty; 0 means every writer is gone.
+ */
+int read_pipe(uint8_t id, uint8_t * buffer, uint64_t bytes) {
 	if (buffer == NULL) {
 		return -1;
 	}
@@ -175,33 +453,30 @@ int write_pipe(uint8_t id, const uint8_t * buffer, uint64_t bytes) {
 		return -1;
 	}
 
-	pipe_t pipe = pipes[id];
-	uint64_t written_bytes = 0;
-
-	while (written_bytes < bytes) {
-		sem_wait(pipe->mutex);
-		if (pipe->data_count == PIPE_BUFFER_SIZE) {
-			pipe->waiting_writers++;
-			sem_post(pipe->mutex);
-
-			sem_wait(pipe->can_write);
-			sem_wait(pipe->mutex);
-			pipe->waiting_writers--;
-			sem_post(pipe->mutex);
-			continue;
-		}
+	if (IS_STD_PIPE(id)) {
+		return read_masked(pipes[id], buffer, bytes);
+	}
+	return read_claimed(pipes[id], buffer, bytes);
+}
 
-		pipe->buffer[pipe->write_idx] = buffer[written_bytes];
-		pipe->write_idx = NEXT_BUFFER_IDX(pipe->write_idx);
-		pipe->data_count++;
+/* Blocks until every byte is in, waking the readers once per chunk */
+int write_pipe(uint8_t id, const uint8_t * buffer, uint64_t bytes) {
+	if (buffer == NULL) {
+		return -1;
+	}
 
-		sem_post(pipe->mutex);
-		sem_post(pipe->can_read);
+	if (bytes == 0) {
+		return 0;
+	}
 
-		written_bytes++;
+	if (id >= MAX_PIPES || pipes[id] == NULL) {
+		return -1;
 	}
 
-	return (int)written_bytes;
+	if (IS_STD_PIPE(id)) {
+		return write_masked(pipes[id], buffer, bytes);
+	}
+	return write_claimed(pipes[id], buffer, bytes);
 }
 
 static void destroy_pipe(uint8_t id, pipe_t pipe) {
@@ -209,14 +484,12 @@ static void destroy_pipe(uint8_t id, pipe_t pipe) {
 		return;
 	}
 
-	sem_destroy(pipe->can_read);
-	sem_destroy(pipe->can_write);
-	sem_destroy(pipe->mutex);
-
-	mem_free(pipe->can_read);
-	mem_free(pipe->can_write);
-	mem_free(pipe->mutex);
-	mem_free(pipe);
+	wait_queue_release(&pipe->readers);
+	wait_queue_release(&pipe->writers);
+	if (pipe->buffer != NULL) {
+		mem_free_sized(pipe->buffer, pipe->size);
+	}
+	kmem_cache_free(pipe_cache, pipe);
 
 	pipes[id] = NULL;
 }
@@ -227,15 +500,23 @@ void unattach_from_pipe(uint8_t id, int pid) {
 	}
 
 	pipe_t pipe = pipes[id];
+	process_t *process = process_lookup((uint32_t)pid);
 
-	sem_remove_process(pipe->can_read, pid);
-	sem_remove_process(pipe->can_write, pid);
-
-	sem_wait(pipe->mutex);
+	uint64_t flags = interrupts_save_and_disable();
+	if (process != NULL && (process->wait_queue == &pipe->readers || process->wait_queue == &pipe->writers)) {
+		wait_queue_cancel(process);
+	}
+	/* A process killed halfway through a transfer still holds its slot */
+	if (pipe->reader == (uint32_t)pid) {
+		release_slot(&pipe->reader, &pipe->readers);
+	}
+	if (pipe->writer == (uint32_t)pid) {
+		release_slot(&pipe->writer, &pipe->writers);
+	}
 	if (pipe->attached_count > 0) {
 		pipe->attached_count--;
 	}
-	sem_post(pipe->mutex);
+	interrupts_restore(flags);
 }
 
 int close_pipe(uint8_t id) {
@@ -244,31 +525,45 @@ int close_pipe(uint8_t id) {
 	}
 
 	pipe_t pipe = pipes[id];
-	int is_std = (id == STDIN || id == STDOUT || id == STDERR);
-
-	if (sem_wait(pipe->mutex) == -1) {
-		return -1;
-	}
+	int is_std = IS_STD_PIPE(id);
 
+	uint64_t flags = interrupts_save_and_disable();
 	uint8_t attached = pipe->attached_count;
-	int release_waiters = (!is_std && attached <= 1);
-	int readers_to_wake = release_waiters ? sem_waiting_count(pipe->can_read) : 0;
-	int writers_to_wake = release_waiters ? sem_waiting_count(pipe->can_write) : 0;
+	if (!is_std && attached <= 1) {
+		wake_all(&pipe->readers);
+		wake_all(&pipe->writers);
+	}
+	interrupts_restore(flags);
 
-	sem_post(pipe->mutex);
+	if (!is_std && attached == 0) {
+		destroy_pipe(id, pipe);
+	}
+	return 0;
+}
 
-	while (readers_to_wake-- > 0) {
-		sem_post(pipe->can_read);
+int resize_pipe(uint8_t id, uint32_t capacity) {
+	if (id >= MAX_PIPES || pipes[id] == NULL) {
+		return -1;
 	}
 
-	while (writers_to_wake-- > 0) {
-		sem_post(pipe->can_write);
+	pipe_t pipe = pipes[id];
+	if (capacity == 0) {
+		return (int)pipe->capacity;
+	}
+	if (IS_STD_PIPE(id) || capacity > PIPE_MAX_CAPACITY) {
+		return -1;
 	}
 
-	if (!is_std && attached == 0) {
-		destroy_pipe(id, pipe);
+	/* Only the limit changes here; the buffer follows on the next write or drain */
+	uint64_t flags = interrupts_save_and_disable();
+	if (pipe_used(pipe) > capacity) {
+		interrupts_restore(flags);
+		return -1;
 	}
-	return 0;
+	pipe->capacity = capacity;
+	wake_side(&pipe->writers);
+	interrupts_restore(flags);
+	return (int)capacity;
 }
 
 void reset_pipes(void) {
@@ -290,18 +585,45 @@ void clear_pipe(uint8_t id) {
 	}
 
 	pipe_t pipe = pipes[id];
-	
-	sem_wait(pipe->mutex);
-	
-	pipe->read_idx = 0;
-	pipe->write_idx = 0;
-	pipe->data_count = 0;
-	
-	int writers_to_wake = sem_waiting_count(pipe->can_write);
-	
-	sem_post(pipe->mutex);
-	
-	while (writers_to_wake-- > 0) {
-		sem_post(pipe->can_write);
+
+	/* Only moves the read position, which a reader mid-copy detects */
+	uint64_t flags = interrupts_save_and_disable();
+	__atomic_store_n(&pipe->read_pos, pipe->write_pos, __ATOMIC_RELEASE);
+	wake_side(&pipe->writers);
+	interrupts_restore(flags);
+}
+
+static void side_info(sem_info_t *info, uint8_t id, char side, const pipe_side_stats_t *stats, uint64_t value, uint32_t waiters, uint64_t posts) {
+	memset(info, 0, sizeof(sem_info_t));
+	strcpy(info->name, "pipe_XXX");
+	info->name[5] = '0' + (id / 10);
+	info->name[6] = '0' + (id % 10);
+	info->name[7] = side;
+	info->value = value > UINT32_MAX ? UINT32_MAX : (uint32_t)value;
+	info->waiters = waiters;
+	info->waits = stats->transfers;
+	info->posts = posts;
+	info->blocked_waits = stats->blocked;
+	info->blocked_ticks = stats->blocked_ticks;
+	info->max_blocked_ticks = stats->max_blocked_ticks;
+}
+
+int32_t pipe_snapshot(sem_info_t *buffer, uint32_t capacity) {
+	if (buffer == NULL) {
+		return -1;
+	}
+
+	uint32_t count = 0;
+	for (uint8_t id = 0; id < MAX_PIPES && count + 2 <= capacity; id++) {
+		uint64_t flags = interrupts_save_and_disable();
+		pipe_t pipe = pipes[id];
+		if (pipe != NULL) {
+			uint64_t used = pipe_used(pipe);
+			uint64_t limit = pipe->capacity;
+			side_info(&buffer[count++], id, 'R', &pipe->read_stats, used, pipe->readers.count, pipe->write_stats.transfers);
+			side_info(&buffer[count++], id, 'W', &pipe->write_stats, limit > used ? limit - used : 0, pipe->writers.count, pipe->read_stats.transfers);
+		}
+		interrupts_restore(flags);
 	}
+	return (int32_t)count;
 }
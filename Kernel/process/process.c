@@ -2,11 +2,15 @@
 // PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
 #include <process.h>
 #include <memoryManager.h>
+#include <memProfile.h>
 #include <strings.h>
 #include <lib.h>
 #include <scheduler.h>
 #include <interrupts.h>
 #include <sem.h>
+#include <futex.h>
+#include <sync.h>
+#include <time.h>
 #include <pipes.h>
 #include <queueADT.h>
 
@@ -38,13 +42,75 @@ typedef struct pcb {
 } pcb_t;
 
 static pcb_t *pcb = NULL;
+static process_self_t running_self = {0};
+static uint64_t next_serial = 1;
+
+#define HEAP_BLOCK_MAGIC 0x48454150u
+
+/*
+ * Header of a block allocated on behalf of a process. Blocks are chained
+ * into their owner's list so they can be released one by one when the
+ * owner exits, whoever ends up freeing them in the meantime. An aligned
+ * block pads the front so the payload lands on the boundary; align_shift
+ * records the alignment so the allocation start can be found again.
+ */
+typedef struct heap_block {
+    struct heap_block *prev;
+    struct heap_block *next;
+    uint16_t owner;
+    uint16_t align_shift;
+    uint32_t magic;
+    uint64_t serial;
+} heap_block_t;
+
+/* Bytes between the start of the allocation and the header */
+static size_t heap_block_lead(const heap_block_t *block) {
+    size_t align = (size_t)1u << block->align_shift;
+    return ((sizeof(heap_block_t) + align - 1) & ~(align - 1)) - sizeof(heap_block_t);
+}
+
+static void *heap_block_base(heap_block_t *block) {
+    return (uint8_t *)block - heap_block_lead(block);
+}
+
+static void heap_block_unlink(process_t *owner, heap_block_t *block) {
+    if (block->prev != NULL) {
+        block->prev->next = block->next;
+    } else {
+        owner->heap_blocks = block->next;
+    }
+    if (block->next != NULL) {
+        block->next->prev = block->prev;
+    }
+    block->magic = 0;
+
+    size_t size = mem_usable_size(heap_block_base(block)) - heap_block_lead(block) - sizeof(heap_block_t);
+    owner->heap_bytes = owner->heap_bytes > size ? owner->heap_bytes - size : 0;
+    owner->heap_block_count--;
+}
+
+static void process_release_heap(process_t *process) {
+    uint64_t flags = interrupts_save_and_disable();
+    heap_block_t *block = process->heap_blocks;
+    process->heap_blocks = NULL;
+    process->heap_bytes = 0;
+    process->heap_block_count = 0;
+    interrupts_restore(flags);
+
+    while (block != NULL) {
+        heap_block_t *next = block->next;
+        block->magic = 0;
+        mem_free(heap_block_base(block));
+        block = next;
+    }
+}
 
 void process_table_init(void) {
     if (pcb != NULL) {
         return;
     }
 
-    pcb = (pcb_t *)mem_alloc(sizeof(pcb_t));
+    pcb = (pcb_t *)mem_alloc_tagged(sizeof(pcb_t), MEM_TAG_PROCESS);
     if (pcb == NULL) {
         return;
     }
@@ -124,10 +190,20 @@ void process_set_running(process_t *process) {
 
     if (process == NULL) {
         pcb->running_pid = -1;
+        running_self.pid = 0;
+        running_self.slot = 0;
+        running_self.serial = 0;
         return;
     }
 
     pcb->running_pid = (int32_t)process->pid;
+    running_self.pid = process->pid;
+    running_self.slot = PID_TO_INDEX(process->pid);
+    running_self.serial = process->serial;
+}
+
+const process_self_t *process_self(void) {
+    return &running_self;
 }
 
 bool process_block(process_t *process) {
@@ -178,21 +254,17 @@ void process_free_memory(process_t *process) {
     }
 
     if (process->stack_base != NULL) {
-        mem_free(process->stack_base);
+        mem_free_sized(process->stack_base, PROCESS_STACK_SIZE);
         process->stack_base = NULL;
     }
 
-    if (process->exit_sem != NULL) {
-        sem_destroy(process->exit_sem);
-        mem_free(process->exit_sem);
-        process->exit_sem = NULL;
-    }
-
     if (process->children != NULL) {
         queue_destroy(process->children, NULL);
         process->children = NULL;
     }
 
+    process_release_heap(process);
+
     mem_free(process);
 }
 
@@ -210,6 +282,11 @@ bool process_exit(process_t *process) {
     if (process->state == PROCESS_STATE_READY) {
         scheduler_remove_ready(process);
     }
+
+    futex_cancel(process);
+    wait_queue_cancel(process);
+    sleep_cancel(process);
+    sync_release_process(process);
     
     process->state = PROCESS_STATE_TERMINATED;
 
@@ -230,8 +307,13 @@ bool process_exit(process_t *process) {
     close_pipe(stdin_id);
     close_pipe(stdout_id);
     close_pipe(stderr_id);
+
+    process_release_heap(process);
     
-    sem_post(process->exit_sem);
+    flags = interrupts_save_and_disable();
+    process->exited = true;
+    wake_all(&process->exit_waiters);
+    interrupts_restore(flags);
     
     if (should_force_switch) {
         _force_scheduler_interrupt();
@@ -324,13 +406,14 @@ process_t *createProcess(int argc, char **argv, uint32_t ppid, uint8_t priority,
         return NULL;
     }
 
-    process_t *process = mem_alloc(sizeof(process_t));
+    process_t *process = mem_alloc_tagged(sizeof(process_t), MEM_TAG_PROCESS);
     if (process == NULL) {
         return NULL;
     }
 
     memset(process, 0, sizeof(process_t));
     process->pid = pid;
+    process->serial = next_serial++;
     process->ppid = ppid;
     process->priority = priority;
     process->priority_requested = priority;
@@ -341,6 +424,7 @@ process_t *createProcess(int argc, char **argv, uint32_t ppid, uint8_t priority,
     process->last_quantum_ticks = 0;
     process->argc = argc;
     process->children = NULL;
+    process->sync_queued = -1;
     process->user_entry_point = entry_point;
 
     process_t *parent = NULL;
@@ -362,7 +446,7 @@ process_t *createProcess(int argc, char **argv, uint32_t ppid, uint8_t priority,
     process->fd_targets[STDERR] = stderr_target;
 
     size_t argv_count = (size_t)process->argc + 1u;
-    process->argv = (char **)mem_alloc(sizeof(char *) * argv_count);
+    process->argv = (char **)mem_alloc_tagged(sizeof(char *) * argv_count, MEM_TAG_PROCESS);
     if (process->argv == NULL) {
         process_free_memory(process);
         return NULL;
@@ -371,7 +455,7 @@ process_t *createProcess(int argc, char **argv, uint32_t ppid, uint8_t priority,
 
     for (int i = 0; i < process->argc; i++) {
         size_t arg_len = strlen(argv[i]);
-        process->argv[i] = (char *)mem_alloc(sizeof(char) * (arg_len + 1));
+        process->argv[i] = (char *)mem_alloc_tagged(sizeof(char) * (arg_len + 1), MEM_TAG_PROCESS);
         if (process->argv[i] == NULL) {
             process_free_memory(process);
             return NULL;
@@ -385,7 +469,7 @@ process_t *createProcess(int argc, char **argv, uint32_t ppid, uint8_t priority,
         process->name = process->argv[0];
     }
 
-    void *stack_base = mem_alloc(PROCESS_STACK_SIZE);
+    void *stack_base = mem_alloc_tagged(PROCESS_STACK_SIZE, MEM_TAG_PROCESS);
     if (stack_base == NULL) {
         process_free_memory(process);
         return NULL;
@@ -397,26 +481,6 @@ process_t *createProcess(int argc, char **argv, uint32_t ppid, uint8_t priority,
         (uint64_t)stackInit(stack_top, (void *)process_entry_wrapper, process->argc, process->argv);
     process->context.rsp = prepared_rsp;
 
-    process->exit_sem = sem_create();
-    if (process->exit_sem == NULL) {
-        process_free_memory(process);
-        return NULL;
-    }
-
-    char sem_name[16] = "process";
-    uint32_t pid_digits = pid;
-    for (int idx = 9; idx >= 7; idx--) {
-        sem_name[idx] = '0' + (char)(pid_digits % 10);
-        pid_digits /= 10;
-    }
-    sem_name[10] = '\0';
-
-    sem_init(process->exit_sem, sem_name, 0);
-    if (process->exit_sem->name == NULL || process->exit_sem->waiting_processes == NULL) {
-        process_free_memory(process);
-        return NULL;
-    }
-
     bool stdin_attached = false;
     bool stdout_attached = false;
     bool stderr_attached = false;
@@ -546,7 +610,7 @@ static void init_first_process_entry(int argc, char **argv) {
     }
 }
 int32_t add_first_process(void) {
-    int std_in = open_pipe();
+    int std_in = open_pipe(0);
     if (std_in < 0) {
         return -1;
     }
@@ -558,7 +622,7 @@ int32_t add_first_process(void) {
         close_pipe((uint8_t)std_in);
         return -1;
     }
-    int std_out = open_pipe();
+    int std_out = open_pipe(0);
     if (std_out < 0) {
         close_pipe((uint8_t)std_in);
         return -1;
@@ -573,7 +637,7 @@ int32_t add_first_process(void) {
         close_pipe((uint8_t)std_in);
         return -1;
     }
-    int std_err = open_pipe();
+    int std_err = open_pipe(0);
     if (std_err < 0) {
         close_pipe((uint8_t)std_out);
         close_pipe((uint8_t)std_in);
@@ -652,6 +716,13 @@ int32_t print_process_list(void) {
         printHex(process->context.rsp);
         newLine();
 
+        print("    Heap: ");
+        printDec(process->heap_bytes);
+        print(" bytes in ");
+        printDec(process->heap_block_count);
+        print(" blocks");
+        newLine();
+
         print("    Remaining quantum: ");
         printDec(process->remaining_quantum);
         print(" | Last quantum ticks: ");
@@ -673,6 +744,51 @@ int32_t print_process_list(void) {
     return count;
 }
 
+int32_t process_snapshot(process_info_t *buffer, uint32_t capacity) {
+    if (pcb == NULL || buffer == NULL) {
+        return -1;
+    }
+
+    uint64_t flags = interrupts_save_and_disable();
+    uint32_t count = 0;
+
+    for (uint32_t i = 0; i < PROCESS_MAX_PROCESSES && count < capacity; ++i) {
+        process_t *process = pcb->processes[i];
+        if (process == NULL) {
+            continue;
+        }
+
+        process_info_t *info = &buffer[count++];
+        memset(info, 0, sizeof(process_info_t));
+        info->pid = process->pid;
+        info->ppid = process->ppid;
+        if (process->name != NULL) {
+            size_t len = strlen(process->name);
+            if (len >= PROCESS_NAME_MAX) {
+                len = PROCESS_NAME_MAX - 1;
+            }
+            memcpy(info->name, process->name, len);
+        }
+        info->state = (uint8_t)process->state;
+        info->priority = process->priority;
+        info->foreground = pcb->foreground_pid == (int32_t)process->pid;
+        info->cpu_ticks = process->cpu_ticks;
+        info->ready_wait_ticks = process->ready_wait_ticks;
+        info->context_switches = process->context_switches;
+        info->stack_size = PROCESS_STACK_SIZE;
+        if (process->stack_base != NULL) {
+            uint64_t stack_top = (uint64_t)process->stack_base + PROCESS_STACK_SIZE;
+            if (process->context.rsp > (uint64_t)process->stack_base && process->context.rsp <= stack_top) {
+                info->stack_used = stack_top - process->context.rsp;
+            }
+        }
+        info->heap_used = process->heap_bytes;
+    }
+
+    interrupts_restore(flags);
+    return (int32_t)count;
+}
+
 static bool is_child(process_t *parent, process_t *process) {
     if (parent == NULL || process == NULL) {
         return false;
@@ -680,12 +796,16 @@ static bool is_child(process_t *parent, process_t *process) {
     return process->ppid == parent->pid;
 }
 
+static bool has_exited(void *process) {
+    return ((process_t *)process)->exited;
+}
+
 static int32_t reap_child_process(process_t *process) {
     if (process == NULL) {
         return -1;
     }
 
-    sem_wait(process->exit_sem);
+    wait_event(&process->exit_waiters, has_exited, process);
 
     process_unregister(process->pid);
     process_free_memory(process);
@@ -847,3 +967,121 @@ int get_foreground_process_pid(void) {
     
     return pcb->foreground_pid; 
 }
+
+/* Links a freshly allocated block into its owner's list and returns the payload */
+static void *heap_block_attach(process_t *process, heap_block_t *block, uint16_t align_shift) {
+    block->owner = (uint16_t)process->pid;
+    block->align_shift = align_shift;
+    block->magic = HEAP_BLOCK_MAGIC;
+    block->serial = process->serial;
+
+    uint64_t flags = interrupts_save_and_disable();
+    block->prev = NULL;
+    block->next = process->heap_blocks;
+    if (process->heap_blocks != NULL) {
+        process->heap_blocks->prev = block;
+    }
+    process->heap_blocks = block;
+    process->heap_block_count++;
+    process->heap_bytes += mem_usable_size(heap_block_base(block)) - heap_block_lead(block) - sizeof(heap_block_t);
+    interrupts_restore(flags);
+
+    return block + 1;
+}
+
+void *process_heap_alloc(process_t *process, size_t size) {
+    if (process == NULL || size == 0 || size > SIZE_MAX - sizeof(heap_block_t)) {
+        return NULL;
+    }
+
+    heap_block_t *block = mem_alloc_tagged(sizeof(heap_block_t) + size, MEM_TAG_USER);
+    if (block == NULL) {
+        return NULL;
+    }
+    return heap_block_attach(process, block, 0);
+}
+
+void *process_heap_alloc_aligned(process_t *process, size_t size, size_t align) {
+    if (process == NULL || size == 0 || align == 0 || (align & (align - 1)) != 0) {
+        return NULL;
+    }
+
+    uint16_t shift = (uint16_t)__builtin_ctzll((uint64_t)align);
+    size_t offset = (sizeof(heap_block_t) + align - 1) & ~(align - 1);
+    if (offset < sizeof(heap_block_t) || size > SIZE_MAX - offset) {
+        return NULL;
+    }
+
+    uint8_t *base = mem_alloc_aligned_tagged(offset + size, align, MEM_TAG_USER);
+    if (base == NULL) {
+        return NULL;
+    }
+    return heap_block_attach(process, (heap_block_t *)(base + offset) - 1, shift);
+}
+
+void *process_heap_alloc_zeroed(process_t *process, size_t size) {
+    void *ptr = process_heap_alloc(process, size);
+    if (ptr != NULL) {
+        memzero(ptr, size);
+    }
+    return ptr;
+}
+
+/*
+ * The header moves with the block, so it leaves the owner's list for the
+ * duration of the resize and is linked back wherever it ends up. Aligned
+ * blocks are copied by hand since mem_realloc does not keep alignment.
+ */
+void *process_heap_realloc(void *ptr, size_t size) {
+    if (ptr == NULL || size == 0 || size > SIZE_MAX - sizeof(heap_block_t)) {
+        return NULL;
+    }
+
+    heap_block_t *block = (heap_block_t *)ptr - 1;
+    uint64_t flags = interrupts_save_and_disable();
+    process_t *owner = block->magic == HEAP_BLOCK_MAGIC ? process_lookup(block->owner) : NULL;
+    if (owner == NULL || owner->serial != block->serial) {
+        interrupts_restore(flags);
+        return NULL;
+    }
+
+    void *result = NULL;
+    if (block->align_shift != 0) {
+        size_t old_size = mem_usable_size(heap_block_base(block)) - heap_block_lead(block) - sizeof(heap_block_t);
+        result = process_heap_alloc_aligned(owner, size, (size_t)1u << block->align_shift);
+        if (result != NULL) {
+            memcpy(result, ptr, old_size < size ? old_size : size);
+            heap_block_unlink(owner, block);
+            mem_free(heap_block_base(block));
+        }
+        interrupts_restore(flags);
+        return result;
+    }
+
+    heap_block_unlink(owner, block);
+    heap_block_t *resized = mem_realloc(block, sizeof(heap_block_t) + size);
+    /* On failure the old block is still valid and goes back on the list */
+    result = heap_block_attach(owner, resized != NULL ? resized : block, 0);
+    interrupts_restore(flags);
+    return resized != NULL ? result : NULL;
+}
+
+int32_t process_heap_free(void *ptr) {
+    if (ptr == NULL) {
+        return -1;
+    }
+
+    heap_block_t *block = (heap_block_t *)ptr - 1;
+    uint64_t flags = interrupts_save_and_disable();
+    process_t *owner = block->magic == HEAP_BLOCK_MAGIC ? process_lookup(block->owner) : NULL;
+    /* A block whose owner is gone was already released along with it */
+    if (owner == NULL || owner->serial != block->serial) {
+        interrupts_restore(flags);
+        return -1;
+    }
+
+    heap_block_unlink(owner, block);
+    interrupts_restore(flags);
+    mem_free(heap_block_base(block));
+    return 0;
+}
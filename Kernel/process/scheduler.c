@@ -6,6 +6,8 @@
 #include <queueADT.h>
 #include <interrupts.h>
 #include <memoryManager.h>
+#include <memProfile.h>
+#include <time.h>
 
 typedef struct scheduler_state {
     process_t *current;
@@ -107,7 +109,7 @@ void scheduler_init(void) {
         scheduler.ready_queues[i] = queue;
     }
 
-    char **argv_idle = mem_alloc(sizeof(char *));
+    char **argv_idle = mem_alloc_tagged(sizeof(char *), MEM_TAG_SCHEDULER);
     argv_idle[0] = "idle";
     scheduler.idle = createProcess(1, argv_idle, 0, SCHEDULER_MIN_PRIORITY, 0, idle_process_entry);
     interrupts_restore(flags);
@@ -137,6 +139,7 @@ void scheduler_add_ready(process_t *process) {
     process->remaining_quantum = SCHEDULER_DEFAULT_QUANTUM;
     process->last_quantum_ticks = 0;
     process->ready_since_tick = scheduler.metrics.total_ticks;
+    process->ready_enqueued_tick = (uint64_t)ticks_elapsed();
     queue_push(queue_for_priority(process->priority), process);
     interrupts_restore(flags);
 }
@@ -175,6 +178,12 @@ void scheduler_clear_current(process_t *process) {
     }
 }
 
+void scheduler_charge_tick(void) {
+    if (scheduler.current != NULL) {
+        scheduler.current->cpu_ticks++;
+    }
+}
+
 
 void *schedule_tick(void *current_rsp) {
     scheduler.metrics.total_ticks++;
@@ -219,6 +228,8 @@ void *schedule_tick(void *current_rsp) {
                 scheduler.idle->state = PROCESS_STATE_READY;
                 continue;
             }
+            next->ready_wait_ticks += (uint64_t)ticks_elapsed() - next->ready_enqueued_tick;
+            next->context_switches++;
             scheduler.current = next;
             scheduler.current->state = PROCESS_STATE_RUNNING;
             scheduler.current->remaining_quantum = SCHEDULER_DEFAULT_QUANTUM - 1;
@@ -234,6 +245,7 @@ void *schedule_tick(void *current_rsp) {
         scheduler.idle->state = PROCESS_STATE_RUNNING;
         if (scheduler.current != scheduler.idle) {
             scheduler.metrics.context_switches++;
+            scheduler.idle->context_switches++;
         }
         scheduler.current = scheduler.idle;
         process_set_running(scheduler.idle);
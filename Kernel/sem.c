@@ -1,7 +1,7 @@
 // This is a personal academic project. Dear PVS-Studio, please check it.
 // PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
 #include <sem.h>
-#include <queueADT.h>
+#include <hashMap.h>
 #include <stdint.h>
 #include <lib.h>
 #include <memoryManager.h>
@@ -9,17 +9,59 @@
 #include <process.h>
 #include <scheduler.h>
 #include <interrupts.h>
+#include <slab.h>
+#include <futex.h>
+#include <time.h>
+#include <pipes.h>
 
-static queue_t *registered_semaphores = NULL;
+/* Names up to this length (with the terminator) come from a slab cache */
+#define SEM_NAME_CACHE_SIZE 32
+
+/* Keyed by each semaphore's own name buffer, which lives as long as the entry */
+static hash_map_t *registered_semaphores = NULL;
 static uint8_t registry_lock = 0;
 
+static kmem_cache_t *sem_cache = NULL;
+static kmem_cache_t *sem_name_cache = NULL;
+
+/*
+ * One incq, which no interrupt can split on this single CPU; cheaper than
+ * a locked add and enough for statistics. libsys bumps the same counters
+ * the same way.
+ */
+static inline void stat_increment(volatile uint64_t *counter) {
+    __asm__ volatile("incq %0" : "+m"(*counter));
+}
+
 static bool timer_tick_is_disabled(void) {
     return (picMasterGetMask() & 0x01) != 0;
 }
 
+static void ensure_caches(void) {
+    if (sem_cache == NULL) {
+        sem_cache = kmem_cache_create("sem", sizeof(sem_t), MEM_TAG_SEM);
+    }
+    if (sem_name_cache == NULL) {
+        sem_name_cache = kmem_cache_create("sem_name", SEM_NAME_CACHE_SIZE, MEM_TAG_SEM);
+    }
+}
+
+static char *name_alloc(size_t size) {
+    ensure_caches();
+    return size <= SEM_NAME_CACHE_SIZE ? kmem_cache_alloc(sem_name_cache) : mem_alloc_tagged(size, MEM_TAG_SEM);
+}
+
+static void name_free(char *name) {
+    if (strlen(name) + 1 <= SEM_NAME_CACHE_SIZE) {
+        kmem_cache_free(sem_name_cache, name);
+    } else {
+        mem_free(name);
+    }
+}
+
 static void ensure_registry(void) {
     if (registered_semaphores == NULL) {
-        registered_semaphores = queue_create();
+        registered_semaphores = hash_map_create_str(MEM_TAG_SEM);
     }
 }
 
@@ -27,19 +69,16 @@ static sem_t *find_registered(const char *name) {
     if (registered_semaphores == NULL || name == NULL) {
         return NULL;
     }
-
-    queue_iterator_t it = queue_iter(registered_semaphores);
-    while (queue_iter_has_next(&it)) {
-        sem_t *candidate = queue_iter_next(&it);
-        if (candidate != NULL && candidate->name != NULL && strcmp(candidate->name, name) == 0) {
-            return candidate;
-        }
-    }
-    return NULL;
+    return hash_map_get_str(registered_semaphores, name);
 }
 
 sem_t *sem_create(void) {
-    return mem_alloc(sizeof(sem_t));
+    ensure_caches();
+    return kmem_cache_alloc(sem_cache);
+}
+
+void sem_free(sem_t *sem) {
+    kmem_cache_free(sem_cache, sem);
 }
 
 sem_t *sem_find(const char *name) {
@@ -57,18 +96,22 @@ void sem_init(sem_t *sem, const char *name, uint32_t initial_count){
 
     ensure_registry();
 
-    sem->name = mem_alloc(strlen(name) + 1);
+    sem->count = initial_count;
+    sem->waiters = 0;
+    sem->waits = 0;
+    sem->posts = 0;
+    sem->blocked_waits = 0;
+    sem->blocked_ticks = 0;
+    sem->max_blocked_ticks = 0;
+    sem->name = name_alloc(strlen(name) + 1);
     if (sem->name == NULL) {
         return;
     }
     strcpy(sem->name, name);
-    sem->count = initial_count;
-    sem->waiting_processes = queue_create();
-    sem->lock = 0;
 
     semLock(&registry_lock);
     if (find_registered(name) == NULL) {
-        queue_push(registered_semaphores, sem);
+        hash_map_put_str(registered_semaphores, sem->name, sem);
     }
     semUnlock(&registry_lock);
 }
@@ -79,151 +122,172 @@ void sem_destroy(sem_t *sem) {
     }
 
     semLock(&registry_lock);
-    if (registered_semaphores != NULL) {
-        queue_remove(registered_semaphores, sem);
+    if (sem->name != NULL && find_registered(sem->name) == sem) {
+        hash_map_remove_str(registered_semaphores, sem->name);
     }
     semUnlock(&registry_lock);
 
-    semLock(&sem->lock);
-
-    while (sem->waiting_processes != NULL && !queue_is_empty(sem->waiting_processes)) {
-        process_t *process = (process_t *)queue_pop(sem->waiting_processes);
-        if (process != NULL) {
-            process_unblock(process);
-        }
-    }
-
-    queue_destroy(sem->waiting_processes, NULL);
-    sem->waiting_processes = NULL;
+    futex_release(&sem->count);
     sem->count = 0;
-
-    semUnlock(&sem->lock);
-    sem->lock = 0;
+    sem->waiters = 0;
 
     if (sem->name != NULL) {
-        mem_free(sem->name);
+        name_free(sem->name);
         sem->name = NULL;
     }
 }
 
 int sem_post(sem_t *sem){
-    int ret = -1;
-    bool should_force_scheduler = false;
     if(sem == NULL){
-        return ret;
+        return -1;
     }
 
-    semLock(&sem->lock);
-    
-    bool woke_process = false;
-    while (sem->waiting_processes != NULL && !queue_is_empty(sem->waiting_processes)) {
-        process_t *process = (process_t *)queue_pop(sem->waiting_processes);
-        if (process == NULL) {
-            break;
-        }
-        if (process_unblock(process)) {
-            should_force_scheduler = true;
-            woke_process = true;
-            break;
-        }
-    }
+    __sync_fetch_and_add(&sem->count, 1);
+    stat_increment(&sem->posts);
 
-    if (!woke_process) {
-        sem->count++;
+    if (sem->waiters != 0 && futex_wake(&sem->count, 1) > 0 && timer_tick_is_disabled()) {
+        process_yield();
     }
 
-    ret = 0;
-
-    semUnlock(&sem->lock);
+    return 0;
+}
 
-    if (should_force_scheduler && timer_tick_is_disabled()) {
-        process_yield();
+static void record_acquire(sem_t *sem, bool slept, uint64_t start) {
+    stat_increment(&sem->waits);
+    if (!slept) {
+        return;
     }
 
-    return ret;
+    uint64_t blocked = (uint64_t)ticks_elapsed() - start;
+    uint64_t flags = interrupts_save_and_disable();
+    sem->blocked_waits++;
+    sem->blocked_ticks += blocked;
+    if (blocked > sem->max_blocked_ticks) {
+        sem->max_blocked_ticks = blocked;
+    }
+    interrupts_restore(flags);
 }
 
-int sem_wait(sem_t *sem){
-    int ret = -1;
-    bool blocked = false;
-    if(sem == NULL){
-        return ret;
+/*
+ * Same protocol as semWait in libsys, which falls back to it once the
+ * semaphore is empty. A timed acquire gives up once the deadline tick has
+ * passed.
+ */
+static int sem_acquire(sem_t *sem, bool timed, uint64_t timeout_ticks) {
+    if(sem == NULL || scheduler_current() == NULL){
+        return -1;
     }
-    
-    semLock(&sem->lock);
 
-    if(sem->count > 0){
-        sem->count--;
-        ret = 0;
-    } else {
-        process_t *current_process = scheduler_current();
-        if (current_process != NULL) {
-            queue_push(sem->waiting_processes, current_process);
-            blocked = process_block(current_process);
-            ret = 0;
+    uint64_t start = (uint64_t)ticks_elapsed();
+    uint64_t deadline = start + timeout_ticks;
+    bool slept = false;
+    while (1) {
+        uint32_t count = sem->count;
+        if (count > 0) {
+            if (__sync_bool_compare_and_swap(&sem->count, count, count - 1)) {
+                record_acquire(sem, slept, start);
+                return 0;
+            }
+            continue;
         }
-    }
 
-    semUnlock(&sem->lock);
+        uint64_t remaining = 0;
+        if (timed) {
+            uint64_t now = (uint64_t)ticks_elapsed();
+            if (now >= deadline) {
+                return SEM_TIMEDOUT;
+            }
+            remaining = deadline - now;
+        }
 
-    if (blocked) {
-        _force_scheduler_interrupt();
+        slept = true;
+        int32_t result = futex_wait_counted(&sem->count, 0, remaining, &sem->waiters);
+        if (result == FUTEX_RELEASED || result < 0) {
+            return -1;
+        }
     }
+}
+
+int sem_wait(sem_t *sem){
+    return sem_acquire(sem, false, 0);
+}
 
-    return ret;
+int sem_timedwait(sem_t *sem, uint32_t ms) {
+    uint64_t timeout_ticks = ((uint64_t)ms * SECONDS_TO_TICKS + 999) / 1000;
+    return sem_acquire(sem, true, timeout_ticks);
 }
 
 int sem_waiting_count(sem_t *sem) {
     if (sem == NULL) {
         return -1;
     }
-
-    int count = 0;
-    semLock(&sem->lock);
-    if (sem->waiting_processes != NULL) {
-        count = (int)queue_size(sem->waiting_processes);
-    }
-    semUnlock(&sem->lock);
-    return count;
+    return (int)futex_waiters(&sem->count);
 }
 
 int sem_get_value(sem_t *sem) {
     if (sem == NULL) {
         return -1;
     }
-    semLock(&sem->lock);
-    int value = (int)sem->count;
-    semUnlock(&sem->lock);
-    return value;
+    return (int)sem->count;
 }
 
-int sem_remove_process(sem_t *sem, int pid) {
+int sem_set_value(sem_t *sem, uint32_t new_value) {
     if (sem == NULL) {
         return -1;
     }
 
-    return queue_remove(sem->waiting_processes, (void *)(uintptr_t)pid);
+    uint32_t current = __sync_lock_test_and_set(&sem->count, new_value);
+    if (new_value > current && sem->waiters != 0) {
+        futex_wake(&sem->count, new_value - current);
+    }
+
+    return 0;
 }
 
-int sem_set_value(sem_t *sem, uint32_t new_value) {
-    if (sem == NULL) {
-        return -1;
+typedef struct snapshot_cursor {
+    sem_info_t *buffer;
+    uint32_t capacity;
+    uint32_t count;
+} snapshot_cursor_t;
+
+static bool snapshot_one(void *value, void *context) {
+    sem_t *sem = value;
+    snapshot_cursor_t *cursor = context;
+    if (cursor->count >= cursor->capacity) {
+        return false;
     }
 
-    semLock(&sem->lock);
-    uint32_t current = sem->count;
-    semUnlock(&sem->lock);
+    sem_info_t *info = &cursor->buffer[cursor->count++];
+    memset(info, 0, sizeof(sem_info_t));
+    size_t len = strlen(sem->name);
+    if (len >= SEM_NAME_MAX) {
+        len = SEM_NAME_MAX - 1;
+    }
+    memcpy(info->name, sem->name, len);
+    info->value = sem->count;
+    info->waiters = futex_waiters(&sem->count);
+    info->waits = sem->waits;
+    info->posts = sem->posts;
+    info->blocked_waits = sem->blocked_waits;
+    info->blocked_ticks = sem->blocked_ticks;
+    info->max_blocked_ticks = sem->max_blocked_ticks;
+    return true;
+}
 
-    if (new_value > current) {
-        uint32_t delta = new_value - current;
-        for (uint32_t i = 0; i < delta; i++) {
-            sem_post(sem);
-        }
-    } else if (new_value < current) {
-        semLock(&sem->lock);
-        sem->count = new_value;
-        semUnlock(&sem->lock);
+int32_t sem_snapshot(sem_info_t *buffer, uint32_t capacity) {
+    if (buffer == NULL) {
+        return -1;
     }
 
-    return 0;
+    snapshot_cursor_t cursor = { buffer, capacity, 0 };
+    semLock(&registry_lock);
+    hash_map_for_each(registered_semaphores, snapshot_one, &cursor);
+    semUnlock(&registry_lock);
+
+    /* Pipes sleep on wait queues, not semaphores, but are reported alongside */
+    int32_t pipe_entries = pipe_snapshot(buffer + cursor.count, capacity - cursor.count);
+    if (pipe_entries > 0) {
+        cursor.count += (uint32_t)pipe_entries;
+    }
+    return (int32_t)cursor.count;
 }
@@ -0,0 +1,450 @@
+// This is a personal academic project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+#include <sync.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <futex.h>
+#include <process.h>
+#include <scheduler.h>
+#include <interrupts.h>
+#include <slab.h>
+#include <lib.h>
+
+/*
+ * Each object sleeps on a single futex word. State changes happen with
+ * interrupts disabled; sleepers re-check the state after every wake, and
+ * futex_wait refuses to sleep if the word moved since it was sampled.
+ */
+typedef struct sync_object {
+    sync_type_t type;
+    union {
+        struct {
+            /* 0 free, 1 held, 2 held and someone may be sleeping */
+            volatile uint32_t state;
+            uint32_t owner;
+        } mutex;
+        struct {
+            volatile uint32_t sequence;
+        } cond;
+        struct {
+            volatile uint32_t sequence;
+            uint32_t readers;
+            uint32_t writer;
+            uint32_t queued_writers;
+        } rwlock;
+        struct {
+            volatile uint32_t generation;
+            uint32_t parties;
+            uint32_t arrived;
+        } barrier;
+    } as;
+} sync_object_t;
+
+static sync_object_t *objects[SYNC_MAX_OBJECTS];
+static kmem_cache_t *sync_cache = NULL;
+
+static volatile uint32_t *wait_word(sync_object_t *object) {
+    switch (object->type) {
+        case SYNC_MUTEX: return &object->as.mutex.state;
+        case SYNC_COND: return &object->as.cond.sequence;
+        case SYNC_RWLOCK: return &object->as.rwlock.sequence;
+        default: return &object->as.barrier.generation;
+    }
+}
+
+static sync_object_t *lookup(int32_t handle, sync_type_t type) {
+    if (handle < 0 || handle >= SYNC_MAX_OBJECTS) {
+        return NULL;
+    }
+    sync_object_t *object = objects[handle];
+    return (object != NULL && object->type == type) ? object : NULL;
+}
+
+static uint32_t current_pid(void) {
+    process_t *current = scheduler_current();
+    return current == NULL ? 0 : current->pid;
+}
+
+/* Holds are counted in the PCB so process_exit can give them back */
+static void note_hold(int32_t handle, bool taken) {
+    process_t *current = scheduler_current();
+    if (current == NULL) {
+        return;
+    }
+    if (taken) {
+        current->sync_holds[handle]++;
+    } else if (current->sync_holds[handle] > 0) {
+        current->sync_holds[handle]--;
+    }
+}
+
+static uint8_t current_holds(int32_t handle) {
+    process_t *current = scheduler_current();
+    return current == NULL ? 0 : current->sync_holds[handle];
+}
+
+/*
+ * Both release helpers run with interrupts disabled and return whether
+ * sleepers must be woken, which the caller does through the futex word.
+ */
+static bool mutex_release(sync_object_t *object) {
+    bool contended = object->as.mutex.state == 2;
+    object->as.mutex.owner = 0;
+    object->as.mutex.state = 0;
+    return contended;
+}
+
+static bool rwlock_release(sync_object_t *object, uint32_t pid, uint32_t reads) {
+    bool wake = false;
+    if (object->as.rwlock.writer == pid) {
+        object->as.rwlock.writer = 0;
+        wake = true;
+    } else {
+        object->as.rwlock.readers = object->as.rwlock.readers > reads ? object->as.rwlock.readers - reads : 0;
+        wake = object->as.rwlock.readers == 0 && object->as.rwlock.queued_writers > 0;
+    }
+    if (wake) {
+        object->as.rwlock.sequence++;
+    }
+    return wake;
+}
+
+/* A writer leaving the queue may have been all that kept readers out */
+static void writer_dequeued(sync_object_t *object) {
+    if (object->as.rwlock.queued_writers > 0) {
+        object->as.rwlock.queued_writers--;
+    }
+    object->as.rwlock.sequence++;
+    futex_wake(&object->as.rwlock.sequence, UINT32_MAX);
+}
+
+static void forget_handle(int32_t handle) {
+    for (uint32_t pid = PROCESS_FIRST_PID; pid < PROCESS_FIRST_PID + PROCESS_MAX_PROCESSES; pid++) {
+        process_t *process = process_lookup(pid);
+        if (process == NULL) {
+            continue;
+        }
+        process->sync_holds[handle] = 0;
+        if (process->sync_queued == handle) {
+            process->sync_queued = -1;
+        }
+    }
+}
+
+int32_t sync_create(sync_type_t type, uint32_t barrier_count) {
+    if (type > SYNC_BARRIER || (type == SYNC_BARRIER && barrier_count == 0)) {
+        return -1;
+    }
+    if (sync_cache == NULL) {
+        sync_cache = kmem_cache_create("sync", sizeof(sync_object_t), MEM_TAG_SEM);
+    }
+
+    sync_object_t *object = kmem_cache_alloc(sync_cache);
+    if (object == NULL) {
+        return -1;
+    }
+    memzero(object, sizeof(sync_object_t));
+    object->type = type;
+    if (type == SYNC_BARRIER) {
+        object->as.barrier.parties = barrier_count;
+    }
+
+    uint64_t flags = interrupts_save_and_disable();
+    for (int32_t handle = 0; handle < SYNC_MAX_OBJECTS; handle++) {
+        if (objects[handle] == NULL) {
+            objects[handle] = object;
+            interrupts_restore(flags);
+            return handle;
+        }
+    }
+    interrupts_restore(flags);
+
+    kmem_cache_free(sync_cache, object);
+    return -1;
+}
+
+int32_t sync_destroy(int32_t handle) {
+    if (handle < 0 || handle >= SYNC_MAX_OBJECTS) {
+        return -1;
+    }
+
+    uint64_t flags = interrupts_save_and_disable();
+    sync_object_t *object = objects[handle];
+    if (object == NULL) {
+        interrupts_restore(flags);
+        return -1;
+    }
+    objects[handle] = NULL;
+    forget_handle(handle);
+    futex_release(wait_word(object));
+    interrupts_restore(flags);
+
+    kmem_cache_free(sync_cache, object);
+    return 0;
+}
+
+/* Sleeps until *word moves away from expected; false if the object died */
+static bool sleep_on(volatile uint32_t *word, uint32_t expected) {
+    int32_t result = futex_wait(word, expected);
+    return result != FUTEX_RELEASED && result >= 0;
+}
+
+int32_t mutex_lock(int32_t handle) {
+    sync_object_t *object = lookup(handle, SYNC_MUTEX);
+    uint32_t pid = current_pid();
+    if (object == NULL || pid == 0) {
+        return -1;
+    }
+
+    /* Once we have slept, take it as contended so the others get woken too */
+    bool waited = false;
+    while (1) {
+        uint64_t flags = interrupts_save_and_disable();
+        if (object->as.mutex.owner == pid) {
+            interrupts_restore(flags);
+            return -1;
+        }
+        if (object->as.mutex.state == 0) {
+            object->as.mutex.state = waited ? 2 : 1;
+            object->as.mutex.owner = pid;
+            note_hold(handle, true);
+            interrupts_restore(flags);
+            return 0;
+        }
+        object->as.mutex.state = 2;
+        interrupts_restore(flags);
+
+        if (!sleep_on(&object->as.mutex.state, 2)) {
+            return -1;
+        }
+        waited = true;
+    }
+}
+
+int32_t mutex_trylock(int32_t handle) {
+    sync_object_t *object = lookup(handle, SYNC_MUTEX);
+    uint32_t pid = current_pid();
+    if (object == NULL || pid == 0) {
+        return -1;
+    }
+
+    int32_t result = 1;
+    uint64_t flags = interrupts_save_and_disable();
+    if (object->as.mutex.state == 0) {
+        object->as.mutex.state = 1;
+        object->as.mutex.owner = pid;
+        note_hold(handle, true);
+        result = 0;
+    }
+    interrupts_restore(flags);
+    return result;
+}
+
+int32_t mutex_unlock(int32_t handle) {
+    sync_object_t *object = lookup(handle, SYNC_MUTEX);
+    uint32_t pid = current_pid();
+    if (object == NULL || pid == 0) {
+        return -1;
+    }
+
+    uint64_t flags = interrupts_save_and_disable();
+    if (object->as.mutex.owner != pid) {
+        interrupts_restore(flags);
+        return -1;
+    }
+    bool contended = mutex_release(object);
+    note_hold(handle, false);
+    interrupts_restore(flags);
+
+    if (contended) {
+        futex_wake(&object->as.mutex.state, 1);
+    }
+    return 0;
+}
+
+int32_t cond_wait(int32_t cond, int32_t mutex) {
+    sync_object_t *object = lookup(cond, SYNC_COND);
+    sync_object_t *lock = lookup(mutex, SYNC_MUTEX);
+    if (object == NULL || lock == NULL || lock->as.mutex.owner != current_pid()) {
+        return -1;
+    }
+
+    /* Sampled before unlocking, so a signal in between is never lost */
+    uint32_t sequence = object->as.cond.sequence;
+    mutex_unlock(mutex);
+    if (!sleep_on(&object->as.cond.sequence, sequence)) {
+        return -1;
+    }
+    return mutex_lock(mutex);
+}
+
+static int32_t cond_wake(int32_t cond, uint32_t count) {
+    sync_object_t *object = lookup(cond, SYNC_COND);
+    if (object == NULL) {
+        return -1;
+    }
+
+    __sync_fetch_and_add(&object->as.cond.sequence, 1);
+    futex_wake(&object->as.cond.sequence, count);
+    return 0;
+}
+
+int32_t cond_signal(int32_t cond) {
+    return cond_wake(cond, 1);
+}
+
+int32_t cond_broadcast(int32_t cond) {
+    return cond_wake(cond, UINT32_MAX);
+}
+
+int32_t rwlock_read_lock(int32_t handle) {
+    sync_object_t *object = lookup(handle, SYNC_RWLOCK);
+    uint32_t pid = current_pid();
+    if (object == NULL || pid == 0 || object->as.rwlock.writer == pid) {
+        return -1;
+    }
+
+    while (1) {
+        uint64_t flags = interrupts_save_and_disable();
+        if (current_holds(handle) == UINT8_MAX) {
+            interrupts_restore(flags);
+            return -1;
+        }
+        if (object->as.rwlock.writer == 0 && object->as.rwlock.queued_writers == 0) {
+            object->as.rwlock.readers++;
+            note_hold(handle, true);
+            interrupts_restore(flags);
+            return 0;
+        }
+        uint32_t sequence = object->as.rwlock.sequence;
+        interrupts_restore(flags);
+
+        if (!sleep_on(&object->as.rwlock.sequence, sequence)) {
+            return -1;
+        }
+    }
+}
+
+int32_t rwlock_write_lock(int32_t handle) {
+    sync_object_t *object = lookup(handle, SYNC_RWLOCK);
+    uint32_t pid = current_pid();
+    if (object == NULL || pid == 0 || object->as.rwlock.writer == pid) {
+        return -1;
+    }
+
+    /* A reader asking to write would wait for itself forever */
+    process_t *current = scheduler_current();
+    uint64_t flags = interrupts_save_and_disable();
+    if (current->sync_holds[handle] > 0) {
+        interrupts_restore(flags);
+        return -1;
+    }
+    object->as.rwlock.queued_writers++;
+    current->sync_queued = handle;
+    while (object->as.rwlock.writer != 0 || object->as.rwlock.readers != 0) {
+        uint32_t sequence = object->as.rwlock.sequence;
+        interrupts_restore(flags);
+
+        bool alive = sleep_on(&object->as.rwlock.sequence, sequence);
+        flags = interrupts_save_and_disable();
+        /* sync_destroy clears sync_queued, and then the object is gone */
+        if (current->sync_queued != handle) {
+            interrupts_restore(flags);
+            return -1;
+        }
+        if (!alive) {
+            writer_dequeued(object);
+            current->sync_queued = -1;
+            interrupts_restore(flags);
+            return -1;
+        }
+    }
+    object->as.rwlock.queued_writers--;
+    current->sync_queued = -1;
+    object->as.rwlock.writer = pid;
+    note_hold(handle, true);
+    interrupts_restore(flags);
+    return 0;
+}
+
+int32_t rwlock_unlock(int32_t handle) {
+    sync_object_t *object = lookup(handle, SYNC_RWLOCK);
+    uint32_t pid = current_pid();
+    if (object == NULL || pid == 0) {
+        return -1;
+    }
+
+    uint64_t flags = interrupts_save_and_disable();
+    if (object->as.rwlock.writer != pid && (object->as.rwlock.readers == 0 || current_holds(handle) == 0)) {
+        interrupts_restore(flags);
+        return -1;
+    }
+    bool wake = rwlock_release(object, pid, 1);
+    note_hold(handle, false);
+    interrupts_restore(flags);
+
+    /* Everyone re-checks; queued writers keep new readers out meanwhile */
+    if (wake) {
+        futex_wake(&object->as.rwlock.sequence, UINT32_MAX);
+    }
+    return 0;
+}
+
+int32_t barrier_wait(int32_t handle) {
+    sync_object_t *object = lookup(handle, SYNC_BARRIER);
+    if (object == NULL || current_pid() == 0) {
+        return -1;
+    }
+
+    uint64_t flags = interrupts_save_and_disable();
+    uint32_t generation = object->as.barrier.generation;
+    if (++object->as.barrier.arrived == object->as.barrier.parties) {
+        object->as.barrier.arrived = 0;
+        object->as.barrier.generation++;
+        interrupts_restore(flags);
+        futex_wake(&object->as.barrier.generation, UINT32_MAX);
+        return 1;
+    }
+    interrupts_restore(flags);
+
+    while (object->as.barrier.generation == generation) {
+        if (!sleep_on(&object->as.barrier.generation, generation)) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+void sync_release_process(process_t *process) {
+    if (process == NULL) {
+        return;
+    }
+
+    uint64_t flags = interrupts_save_and_disable();
+    /* A writer that dies queued would otherwise keep readers out for good */
+    if (process->sync_queued >= 0) {
+        sync_object_t *object = lookup(process->sync_queued, SYNC_RWLOCK);
+        process->sync_queued = -1;
+        if (object != NULL) {
+            writer_dequeued(object);
+        }
+    }
+
+    for (int32_t handle = 0; handle < SYNC_MAX_OBJECTS; handle++) {
+        uint8_t holds = process->sync_holds[handle];
+        process->sync_holds[handle] = 0;
+        if (holds == 0 || objects[handle] == NULL) {
+            continue;
+        }
+
+        sync_object_t *object = objects[handle];
+        if (object->type == SYNC_MUTEX && object->as.mutex.owner == process->pid) {
+            if (mutex_release(object)) {
+                futex_wake(&object->as.mutex.state, 1);
+            }
+        } else if (object->type == SYNC_RWLOCK && rwlock_release(object, process->pid, holds)) {
+            futex_wake(&object->as.rwlock.sequence, UINT32_MAX);
+        }
+    }
+    interrupts_restore(flags);
+}
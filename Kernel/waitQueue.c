@@ -0,0 +1,172 @@
+// This is a personal academic project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+#include <waitQueue.h>
+#include <stddef.h>
+#include <process.h>
+#include <scheduler.h>
+#include <interrupts.h>
+#include <time.h>
+
+/*
+ * Every operation runs with interrupts disabled, which on this single CPU
+ * is all the locking a queue needs. A queued process points back at its
+ * queue, so timeouts and kills unlink it in O(1).
+ */
+
+void wait_queue_init(wait_queue_t *queue) {
+    if (queue == NULL) {
+        return;
+    }
+    queue->head = NULL;
+    queue->tail = NULL;
+    queue->count = 0;
+}
+
+static void queue_append(wait_queue_t *queue, process_t *process) {
+    process->wait_queue = queue;
+    process->wait_prev = queue->tail;
+    process->wait_next = NULL;
+    if (queue->tail != NULL) {
+        queue->tail->wait_next = process;
+    } else {
+        queue->head = process;
+    }
+    queue->tail = process;
+    queue->count++;
+}
+
+static void queue_unlink(process_t *process) {
+    wait_queue_t *queue = process->wait_queue;
+    if (process->wait_prev != NULL) {
+        process->wait_prev->wait_next = process->wait_next;
+    } else {
+        queue->head = process->wait_next;
+    }
+    if (process->wait_next != NULL) {
+        process->wait_next->wait_prev = process->wait_prev;
+    } else {
+        queue->tail = process->wait_prev;
+    }
+    process->wait_queue = NULL;
+    process->wait_prev = NULL;
+    process->wait_next = NULL;
+    queue->count--;
+}
+
+int32_t wait_queue_sleep(wait_queue_t *queue, uint64_t timeout_ticks) {
+    process_t *current = scheduler_current();
+    if (queue == NULL || current == NULL) {
+        return -1;
+    }
+    if (timeout_ticks > 0 && !sleep_arm(current, timeout_ticks)) {
+        return -1;
+    }
+
+    queue_append(queue, current);
+    current->wait_result = WAIT_WOKEN;
+    if (process_block(current)) {
+        /* A software interrupt, so it switches away even with interrupts off */
+        _force_scheduler_interrupt();
+    }
+
+    /* Still queued means something else unblocked us, e.g. processUnblock */
+    if (current->wait_queue != NULL) {
+        queue_unlink(current);
+    }
+    sleep_cancel(current);
+    return current->wait_result;
+}
+
+int32_t wait_event(wait_queue_t *queue, wait_condition_t condition, void *context) {
+    return wait_event_timeout(queue, condition, context, 0);
+}
+
+int32_t wait_event_timeout(wait_queue_t *queue, wait_condition_t condition, void *context, uint64_t timeout_ticks) {
+    if (queue == NULL || condition == NULL) {
+        return -1;
+    }
+
+    /* Only sleeping needs a running process; interrupt handlers may get here too */
+    uint64_t deadline = (uint64_t)ticks_elapsed() + timeout_ticks;
+    int32_t result = WAIT_WOKEN;
+    uint64_t flags = interrupts_save_and_disable();
+    while (!condition(context)) {
+        uint64_t remaining = 0;
+        if (timeout_ticks > 0) {
+            uint64_t now = (uint64_t)ticks_elapsed();
+            if (now >= deadline) {
+                result = WAIT_TIMEDOUT;
+                break;
+            }
+            remaining = deadline - now;
+        }
+
+        result = wait_queue_sleep(queue, remaining);
+        if (result != WAIT_WOKEN && result != WAIT_TIMEDOUT) {
+            break;
+        }
+        result = WAIT_WOKEN;
+    }
+    interrupts_restore(flags);
+    return result;
+}
+
+int32_t wait_queue_wake(wait_queue_t *queue, uint32_t count, int32_t result) {
+    if (queue == NULL) {
+        return -1;
+    }
+
+    uint64_t flags = interrupts_save_and_disable();
+    int32_t woken = 0;
+    while ((uint32_t)woken < count && queue->head != NULL) {
+        process_t *process = queue->head;
+        queue_unlink(process);
+        process->wait_result = result;
+        sleep_cancel(process);
+        if (process_unblock(process)) {
+            woken++;
+        }
+    }
+    interrupts_restore(flags);
+    return woken;
+}
+
+int32_t wake_one(wait_queue_t *queue) {
+    return wait_queue_wake(queue, 1, WAIT_WOKEN);
+}
+
+int32_t wake_all(wait_queue_t *queue) {
+    return wait_queue_wake(queue, UINT32_MAX, WAIT_WOKEN);
+}
+
+void wait_queue_release(wait_queue_t *queue) {
+    wait_queue_wake(queue, UINT32_MAX, WAIT_RELEASED);
+}
+
+void wait_queue_cancel(process_t *process) {
+    if (process == NULL) {
+        return;
+    }
+
+    uint64_t flags = interrupts_save_and_disable();
+    if (process->wait_queue != NULL) {
+        queue_unlink(process);
+    }
+    interrupts_restore(flags);
+}
+
+bool wait_queue_timeout(process_t *process) {
+    if (process == NULL) {
+        return false;
+    }
+
+    uint64_t flags = interrupts_save_and_disable();
+    if (process->wait_queue == NULL) {
+        interrupts_restore(flags);
+        return false;
+    }
+    queue_unlink(process);
+    process->wait_result = WAIT_TIMEDOUT;
+    interrupts_restore(flags);
+    return true;
+}
@@ -6,6 +6,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include <sys.h>
+#include <syscalls.h>
 #include <test.h>
 #include <exceptions.h>
 
@@ -15,6 +16,13 @@
 #define PIPE_END_OF_INPUT 4
 #define PIPE_READ_ERROR (-1)
 
+#define TOP_MAX_PROCESSES 32
+#define TOP_HEADER_LINES 2
+#define TOP_MAX_LINES (TOP_HEADER_LINES + TOP_MAX_PROCESSES)
+#define TOP_LINE_WIDTH 56
+#define TOP_DEFAULT_INTERVAL_MS 1000
+#define TOP_MIN_INTERVAL_MS 250
+
 int divzero(int argc, char *argv[]) {
     (void)argc;
     (void)argv;
@@ -163,13 +171,53 @@ int tnosync(int argc, char *argv[]) {
 
 // ========== NEW COMMANDS for TP2 ==========
 
+static int mem_print_caches(void);
+static int mem_print_profile(int verbose);
+
 int mem(int argc, char *argv[]) {
-    if (argc > 1) {
-        printf("Usage: mem\n");
+    int verbose = argc == 2 && strcmp(argv[1], "-v") == 0;
+    if (argc > 2 || (argc == 2 && !verbose)) {
+        printf("Usage: mem [-v]\n");
         return 1;
     }
     
-    return printMemStatus();
+    int status = printMemStatus();
+    if (status != 0 || !verbose) {
+        return status;
+    }
+    status = mem_print_caches();
+    if (status != 0) {
+        return status;
+    }
+    return mem_print_profile(0);
+}
+
+int memprof(int argc, char *argv[]) {
+    if (argc > 2) {
+        printf("Usage: memprof [on|off|reset]\n");
+        return 1;
+    }
+
+    if (argc == 2) {
+        uint32_t command;
+        if (strcmp(argv[1], "on") == 0) {
+            command = MEM_PROFILE_ON;
+        } else if (strcmp(argv[1], "off") == 0) {
+            command = MEM_PROFILE_OFF;
+        } else if (strcmp(argv[1], "reset") == 0) {
+            command = MEM_PROFILE_RESET;
+        } else {
+            printf("Usage: memprof [on|off|reset]\n");
+            return 1;
+        }
+        if (memProfileControl(command) < 0) {
+            printf("Error: could not change the allocation profiler\n");
+            return 1;
+        }
+        return 0;
+    }
+
+    return mem_print_profile(1);
 }
 
 int ps(int argc, char *argv[]) {
@@ -181,6 +229,544 @@ int ps(int argc, char *argv[]) {
     return processList();
 }
 
+typedef struct {
+    uint32_t pid;
+    uint64_t cpu_ticks;
+    uint64_t ready_wait_ticks;
+    uint64_t context_switches;
+} top_sample_t;
+
+static char top_screen[TOP_MAX_LINES][TOP_LINE_WIDTH + 1];
+static process_info_t top_snapshot[TOP_MAX_PROCESSES];
+static top_sample_t top_previous[TOP_MAX_PROCESSES];
+
+static void top_put_field(char *line, int *pos, const char *text, int len, int width, int right_align) {
+    int pad = width > len ? width - len : 0;
+    if (right_align) {
+        while (pad-- > 0 && *pos < TOP_LINE_WIDTH) {
+            line[(*pos)++] = ' ';
+        }
+    }
+    for (int i = 0; i < len && *pos < TOP_LINE_WIDTH; i++) {
+        line[(*pos)++] = text[i];
+    }
+    if (!right_align) {
+        while (pad-- > 0 && *pos < TOP_LINE_WIDTH) {
+            line[(*pos)++] = ' ';
+        }
+    }
+    if (*pos < TOP_LINE_WIDTH) {
+        line[(*pos)++] = ' ';
+    }
+}
+
+static void top_put_str(char *line, int *pos, const char *text, int width) {
+    int len = strlen(text);
+    if (len > width) {
+        len = width;
+    }
+    top_put_field(line, pos, text, len, width, 0);
+}
+
+static int top_format_uint(char *dest, uint64_t value) {
+    char digits[20];
+    int count = 0;
+    do {
+        digits[count++] = (char)('0' + (value % 10));
+        value /= 10;
+    } while (value != 0);
+
+    for (int i = 0; i < count; i++) {
+        dest[i] = digits[count - 1 - i];
+    }
+    return count;
+}
+
+static void top_put_uint(char *line, int *pos, uint64_t value, int width) {
+    char text[20];
+    int len = top_format_uint(text, value);
+    top_put_field(line, pos, text, len, width, 1);
+}
+
+/* Prints a value expressed in tenths as "<int>.<frac>" */
+static void top_put_tenths(char *line, int *pos, uint64_t tenths, int width) {
+    char text[24];
+    int len = top_format_uint(text, tenths / 10);
+    text[len++] = '.';
+    text[len++] = (char)('0' + (tenths % 10));
+    top_put_field(line, pos, text, len, width, 1);
+}
+
+static void top_put_label(char *line, int *pos, const char *label, uint64_t value, const char *unit) {
+    char text[32];
+    int len = 0;
+    for (int i = 0; label[i] != '\0' && len < (int)sizeof(text); i++) {
+        text[len++] = label[i];
+    }
+    len += top_format_uint(text + len, value);
+    for (int i = 0; unit[i] != '\0' && len < (int)sizeof(text); i++) {
+        text[len++] = unit[i];
+    }
+    top_put_field(line, pos, text, len, len + 1, 0);
+}
+
+static const char *top_state_name(uint8_t state) {
+    switch (state) {
+        case PROCESS_STATE_READY:
+            return "rdy";
+        case PROCESS_STATE_RUNNING:
+            return "run";
+        case PROCESS_STATE_BLOCKED:
+            return "blk";
+        case PROCESS_STATE_TERMINATED:
+            return "zmb";
+        default:
+            return "?";
+    }
+}
+
+/* Rewrites a screen row only when its contents changed since the last refresh */
+static void top_draw_line(int row, char *line, int len) {
+    if (row >= TOP_MAX_LINES) {
+        return;
+    }
+
+    while (len < TOP_LINE_WIDTH) {
+        line[len++] = ' ';
+    }
+    line[TOP_LINE_WIDTH] = '\0';
+
+    if (strcmp(top_screen[row], line) == 0) {
+        return;
+    }
+
+    setCursorPosition(0, row);
+    sys_write(FD_STDOUT, line, TOP_LINE_WIDTH);
+    strcpy(top_screen[row], line);
+}
+
+static void top_erase_line(int row) {
+    if (row >= TOP_MAX_LINES || top_screen[row][0] == '\0') {
+        return;
+    }
+
+    char line[TOP_LINE_WIDTH + 1];
+    top_draw_line(row, line, 0);
+    top_screen[row][0] = '\0';
+}
+
+static void top_record_samples(int count) {
+    memset(top_previous, 0, sizeof(top_previous));
+    for (int i = 0; i < count; i++) {
+        uint32_t slot = top_snapshot[i].pid - 1;
+        if (slot >= TOP_MAX_PROCESSES) {
+            continue;
+        }
+        top_previous[slot].pid = top_snapshot[i].pid;
+        top_previous[slot].cpu_ticks = top_snapshot[i].cpu_ticks;
+        top_previous[slot].ready_wait_ticks = top_snapshot[i].ready_wait_ticks;
+        top_previous[slot].context_switches = top_snapshot[i].context_switches;
+    }
+}
+
+static uint64_t top_delta(uint64_t current, uint64_t previous) {
+    return current >= previous ? current - previous : current;
+}
+
+static int top_refresh(uint64_t elapsed_ticks, uint64_t uptime_ticks, uint32_t interval_ms) {
+    int count = processSnapshot(top_snapshot, TOP_MAX_PROCESSES);
+    if (count < 0) {
+        return -1;
+    }
+
+    char line[TOP_LINE_WIDTH + 1];
+    int pos;
+    uint64_t busy_ticks = 0;
+
+    for (int i = 0; i < count; i++) {
+        process_info_t *info = &top_snapshot[i];
+        uint32_t slot = info->pid - 1;
+        top_sample_t *prev = (slot < TOP_MAX_PROCESSES && top_previous[slot].pid == info->pid) ? &top_previous[slot] : NULL;
+        uint64_t cpu = top_delta(info->cpu_ticks, prev != NULL ? prev->cpu_ticks : 0);
+        uint64_t wait = top_delta(info->ready_wait_ticks, prev != NULL ? prev->ready_wait_ticks : 0);
+        uint64_t switches = top_delta(info->context_switches, prev != NULL ? prev->context_switches : 0);
+
+        if (strcmp(info->name, "idle") != 0) {
+            busy_ticks += cpu;
+        }
+
+        pos = 0;
+        top_put_uint(line, &pos, info->pid, 3);
+        top_put_str(line, &pos, info->name, 10);
+        top_put_str(line, &pos, top_state_name(info->state), 3);
+        top_put_uint(line, &pos, info->priority, 2);
+        top_put_tenths(line, &pos, cpu * 1000 / elapsed_ticks, 5);
+        top_put_uint(line, &pos, wait * 1000 / TICKS_PER_SECOND, 6);
+        top_put_uint(line, &pos, switches * TICKS_PER_SECOND / elapsed_ticks, 5);
+        top_put_uint(line, &pos, info->stack_used, 5);
+        top_put_uint(line, &pos, info->heap_used, 6);
+        top_draw_line(TOP_HEADER_LINES + i, line, pos);
+    }
+
+    for (int row = TOP_HEADER_LINES + count; row < TOP_MAX_LINES; row++) {
+        top_erase_line(row);
+    }
+
+    pos = 0;
+    top_put_label(line, &pos, "top  up ", uptime_ticks / TICKS_PER_SECOND, "s");
+    top_put_label(line, &pos, "procs ", (uint64_t)count, "");
+    top_put_label(line, &pos, "busy ", busy_ticks * 100 / elapsed_ticks, "%");
+    top_put_label(line, &pos, "every ", interval_ms, "ms");
+    top_draw_line(0, line, pos);
+
+    pos = 0;
+    top_put_field(line, &pos, "PID", 3, 3, 1);
+    top_put_str(line, &pos, "NAME", 10);
+    top_put_str(line, &pos, "ST", 3);
+    top_put_field(line, &pos, "PR", 2, 2, 1);
+    top_put_field(line, &pos, "CPU%", 4, 5, 1);
+    top_put_field(line, &pos, "WAITms", 6, 6, 1);
+    top_put_field(line, &pos, "CSW/s", 5, 5, 1);
+    top_put_field(line, &pos, "STACK", 5, 5, 1);
+    top_put_field(line, &pos, "HEAP", 4, 6, 1);
+    top_draw_line(1, line, pos);
+
+    top_record_samples(count);
+    setCursorPosition(0, TOP_HEADER_LINES + count);
+    return count;
+}
+
+int top(int argc, char *argv[]) {
+    if (argc > 3) {
+        printf("Usage: top [interval_ms] [iterations]\n");
+        return 1;
+    }
+
+    uint32_t interval_ms = TOP_DEFAULT_INTERVAL_MS;
+    int iterations = 0;
+
+    if (argc >= 2) {
+        int parsed = atoi(argv[1]);
+        if (parsed < TOP_MIN_INTERVAL_MS) {
+            printf("Error: interval must be at least %d ms\n", TOP_MIN_INTERVAL_MS);
+            return 1;
+        }
+        interval_ms = (uint32_t)parsed;
+    }
+
+    if (argc == 3) {
+        iterations = atoi(argv[2]);
+        if (iterations <= 0) {
+            printf("Error: iterations must be a positive integer\n");
+            return 1;
+        }
+    }
+
+    memset(top_screen, 0, sizeof(top_screen));
+    clearScreen();
+
+    int count = processSnapshot(top_snapshot, TOP_MAX_PROCESSES);
+    if (count < 0) {
+        printf("Error: could not read the process table\n");
+        return 1;
+    }
+    top_record_samples(count);
+    uint64_t last_ticks = getTicks();
+
+    for (int refresh = 0; iterations == 0 || refresh < iterations; refresh++) {
+        sleep(interval_ms);
+
+        uint64_t now = getTicks();
+        uint64_t elapsed = now > last_ticks ? now - last_ticks : 1;
+        last_ticks = now;
+
+        count = top_refresh(elapsed, now, interval_ms);
+        if (count < 0) {
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+static mem_cache_info_t mem_caches[MEM_CACHE_MAX];
+
+/* One row per kernel slab cache, laid out with the same column helpers as top */
+static int mem_print_caches(void) {
+    int count = memCacheSnapshot(mem_caches, MEM_CACHE_MAX);
+    if (count < 0) {
+        printf("Error: could not read the slab caches\n");
+        return 1;
+    }
+
+    char line[TOP_LINE_WIDTH + 1];
+    int pos = 0;
+    top_put_str(line, &pos, "CACHE", 10);
+    top_put_field(line, &pos, "SIZE", 4, 5, 1);
+    top_put_field(line, &pos, "USED", 4, 6, 1);
+    top_put_field(line, &pos, "TOTAL", 5, 6, 1);
+    top_put_field(line, &pos, "SLABS", 5, 5, 1);
+    top_put_field(line, &pos, "PART", 4, 4, 1);
+    top_put_field(line, &pos, "ALLOCS", 6, 8, 1);
+    line[pos++] = '\n';
+    sys_write(FD_STDOUT, line, pos);
+
+    for (int i = 0; i < count; i++) {
+        mem_cache_info_t *info = &mem_caches[i];
+        pos = 0;
+        top_put_str(line, &pos, info->name, 10);
+        top_put_uint(line, &pos, info->object_size, 5);
+        top_put_uint(line, &pos, info->active_objects, 6);
+        top_put_uint(line, &pos, info->total_objects, 6);
+        top_put_uint(line, &pos, info->slabs, 5);
+        top_put_uint(line, &pos, info->partial_slabs, 4);
+        top_put_uint(line, &pos, info->allocations, 8);
+        line[pos++] = '\n';
+        sys_write(FD_STDOUT, line, pos);
+    }
+    return 0;
+}
+
+int memtrace(int argc, char *argv[]) {
+    if (argc > 2) {
+        printf("Usage: memtrace [on|off|dump]\n");
+        return 1;
+    }
+
+    if (argc == 2) {
+        uint32_t command;
+        if (strcmp(argv[1], "on") == 0) {
+            command = MEM_TRACE_ON;
+        } else if (strcmp(argv[1], "off") == 0) {
+            command = MEM_TRACE_OFF;
+        } else if (strcmp(argv[1], "dump") == 0) {
+            command = MEM_TRACE_DUMP;
+        } else {
+            printf("Usage: memtrace [on|off|dump]\n");
+            return 1;
+        }
+        int64_t result = memTraceControl(command);
+        if (result < 0) {
+            printf("Error: could not change the allocation trace\n");
+            return 1;
+        }
+        if (command == MEM_TRACE_DUMP) {
+            printf("Wrote %d records to the serial port\n", (int)result);
+        }
+        return 0;
+    }
+
+    mem_trace_info_t info;
+    if (memTraceInfo(&info) < 0) {
+        printf("Error: could not read the allocation trace\n");
+        return 1;
+    }
+    printf("Allocation trace: %s, %d of %d records", info.active ? "on" : "off", (int)info.records, (int)info.capacity);
+    printf(" (%d overwritten)\n", (int)info.overwritten);
+    return 0;
+}
+
+static sem_info_t sem_stats[SEM_SNAPSHOT_MAX];
+
+static uint64_t sem_ticks_to_ms(uint64_t ticks) {
+    return ticks * 1000 / TICKS_PER_SECOND;
+}
+
+/* Most contended first: time spent blocked, then blocked waits, then traffic */
+static int sem_more_contended(const sem_info_t *a, const sem_info_t *b) {
+    if (a->blocked_ticks != b->blocked_ticks) {
+        return a->blocked_ticks > b->blocked_ticks;
+    }
+    if (a->blocked_waits != b->blocked_waits) {
+        return a->blocked_waits > b->blocked_waits;
+    }
+    return a->waits + a->posts > b->waits + b->posts;
+}
+
+int semstat(int argc, char *argv[]) {
+    int show_idle = argc == 2 && strcmp(argv[1], "all") == 0;
+    if (argc > 2 || (argc == 2 && !show_idle)) {
+        printf("Usage: semstat [all]\n");
+        return 1;
+    }
+
+    int count = semSnapshot(sem_stats, SEM_SNAPSHOT_MAX);
+    if (count < 0) {
+        printf("Error: could not read the semaphores\n");
+        return 1;
+    }
+
+    for (int i = 1; i < count; i++) {
+        sem_info_t current = sem_stats[i];
+        int j = i - 1;
+        while (j >= 0 && sem_more_contended(&current, &sem_stats[j])) {
+            sem_stats[j + 1] = sem_stats[j];
+            j--;
+        }
+        sem_stats[j + 1] = current;
+    }
+
+    char line[TOP_LINE_WIDTH + 1];
+    int pos = 0;
+    top_put_str(line, &pos, "NAME", 10);
+    top_put_field(line, &pos, "VAL", 3, 3, 1);
+    top_put_field(line, &pos, "SLP", 3, 3, 1);
+    top_put_field(line, &pos, "WAITS", 5, 7, 1);
+    top_put_field(line, &pos, "POSTS", 5, 7, 1);
+    top_put_field(line, &pos, "BLOCK", 5, 6, 1);
+    top_put_field(line, &pos, "TOT_MS", 6, 7, 1);
+    top_put_field(line, &pos, "MAXMS", 5, 5, 1);
+    line[pos++] = '\n';
+    sys_write(FD_STDOUT, line, pos);
+
+    int hidden = 0;
+    for (int i = 0; i < count; i++) {
+        sem_info_t *info = &sem_stats[i];
+        if (!show_idle && info->waits == 0 && info->posts == 0 && info->waiters == 0) {
+            hidden++;
+            continue;
+        }
+        pos = 0;
+        top_put_str(line, &pos, info->name, 10);
+        top_put_uint(line, &pos, info->value, 3);
+        top_put_uint(line, &pos, info->waiters, 3);
+        top_put_uint(line, &pos, info->waits, 7);
+        top_put_uint(line, &pos, info->posts, 7);
+        top_put_uint(line, &pos, info->blocked_waits, 6);
+        top_put_uint(line, &pos, sem_ticks_to_ms(info->blocked_ticks), 7);
+        top_put_uint(line, &pos, sem_ticks_to_ms(info->max_blocked_ticks), 5);
+        line[pos++] = '\n';
+        sys_write(FD_STDOUT, line, pos);
+    }
+    if (hidden > 0) {
+        printf("(%d idle semaphores hidden, semstat all shows them)\n", hidden);
+    }
+    return 0;
+}
+
+static mem_profile_info_t mem_profile;
+
+static const char *mem_tag_names[MEM_TAG_COUNT] = {
+    "kernel", "scheduler", "process", "sem", "pipes", "user"
+};
+
+static void mem_put_hex(char *line, int *pos, uint64_t value, int width) {
+    char text[18];
+    int len = 0;
+    text[len++] = '0';
+    text[len++] = 'x';
+    int shift = 60;
+    while (shift > 0 && ((value >> shift) & 0xF) == 0) {
+        shift -= 4;
+    }
+    for (; shift >= 0; shift -= 4) {
+        text[len++] = "0123456789abcdef"[(value >> shift) & 0xF];
+    }
+    top_put_field(line, pos, text, len, width, 0);
+}
+
+static void mem_write_line(char *line, int pos) {
+    line[pos++] = '\n';
+    sys_write(FD_STDOUT, line, pos);
+}
+
+/* Summary always; size histogram, tags and top call sites when detailed */
+static int mem_print_profile(int detailed) {
+    if (memProfileSnapshot(&mem_profile) < 0) {
+        printf("Error: could not read the allocation profiler\n");
+        return 1;
+    }
+
+    if (!mem_profile.enabled && mem_profile.allocations == 0) {
+        printf("Allocation profiler: off (memprof on)\n");
+        return 0;
+    }
+
+    uint64_t seconds = mem_profile.ticks / TICKS_PER_SECOND;
+    uint64_t window = mem_profile.ticks > 0 ? mem_profile.ticks : 1;
+    char line[TOP_LINE_WIDTH + 1];
+    int pos = 0;
+    top_put_str(line, &pos, mem_profile.enabled ? "prof on" : "prof off", 8);
+    top_put_label(line, &pos, "for ", seconds, "s");
+    top_put_label(line, &pos, "allocs ", mem_profile.allocations * TICKS_PER_SECOND / window, "/s");
+    top_put_label(line, &pos, "frees ", mem_profile.frees * TICKS_PER_SECOND / window, "/s");
+    mem_write_line(line, pos);
+
+    pos = 0;
+    top_put_label(line, &pos, "live ", mem_profile.live_bytes, "B");
+    top_put_label(line, &pos, "peak ", mem_profile.peak_bytes, "B");
+    top_put_label(line, &pos, "untracked ", mem_profile.untracked_frees, "");
+    top_put_label(line, &pos, "dropped ", mem_profile.dropped, "");
+    mem_write_line(line, pos);
+
+    pos = 0;
+    top_put_str(line, &pos, "TAG", 10);
+    top_put_field(line, &pos, "LIVE", 4, 8, 1);
+    top_put_field(line, &pos, "BLOCKS", 6, 6, 1);
+    top_put_field(line, &pos, "ALLOCS", 6, 8, 1);
+    mem_write_line(line, pos);
+    for (int i = 0; i < MEM_TAG_COUNT; i++) {
+        mem_profile_usage_t *usage = &mem_profile.tags[i];
+        if (usage->allocations == 0) {
+            continue;
+        }
+        pos = 0;
+        top_put_str(line, &pos, mem_tag_names[i], 10);
+        top_put_uint(line, &pos, usage->live_bytes, 8);
+        top_put_uint(line, &pos, usage->live_blocks, 6);
+        top_put_uint(line, &pos, usage->allocations, 8);
+        mem_write_line(line, pos);
+    }
+
+    if (!detailed) {
+        return 0;
+    }
+
+    pos = 0;
+    top_put_str(line, &pos, "SIZE", 10);
+    top_put_field(line, &pos, "ALLOCS", 6, 8, 1);
+    mem_write_line(line, pos);
+    for (int i = 0; i < MEM_PROFILE_BUCKETS; i++) {
+        if (mem_profile.histogram[i] == 0) {
+            continue;
+        }
+        /* Bucket i holds requests in (2^(i+2), 2^(i+3)]; the last one is open */
+        uint64_t limit = (uint64_t)8 << (i < MEM_PROFILE_BUCKETS - 1 ? i : i - 1);
+        pos = 0;
+        top_put_label(line, &pos, i < MEM_PROFILE_BUCKETS - 1 ? "<=" : ">", limit, "");
+        while (pos < 11) {
+            line[pos++] = ' ';
+        }
+        top_put_uint(line, &pos, mem_profile.histogram[i], 8);
+        mem_write_line(line, pos);
+    }
+
+    pos = 0;
+    top_put_str(line, &pos, "CALLER", 10);
+    top_put_str(line, &pos, "TAG", 9);
+    top_put_field(line, &pos, "LIVE", 4, 8, 1);
+    top_put_field(line, &pos, "BLOCKS", 6, 6, 1);
+    top_put_field(line, &pos, "ALLOCS", 6, 8, 1);
+    mem_write_line(line, pos);
+    for (int i = 0; i < MEM_PROFILE_TOP_SITES; i++) {
+        mem_profile_site_t *site = &mem_profile.sites[i];
+        if (site->address == 0) {
+            break;
+        }
+        pos = 0;
+        mem_put_hex(line, &pos, site->address, 10);
+        top_put_str(line, &pos, site->tag < MEM_TAG_COUNT ? mem_tag_names[site->tag] : "?", 9);
+        top_put_uint(line, &pos, site->usage.live_bytes, 8);
+        top_put_uint(line, &pos, site->usage.live_blocks, 6);
+        top_put_uint(line, &pos, site->usage.allocations, 8);
+        mem_write_line(line, pos);
+    }
+    if (mem_profile.site_count > MEM_PROFILE_TOP_SITES) {
+        printf("(%d call sites, showing the top %d by live bytes)\n", (int)mem_profile.site_count, MEM_PROFILE_TOP_SITES);
+    }
+    return 0;
+}
+
 int loop(int argc, char *argv[]) {
     uint32_t seconds = 1;
     
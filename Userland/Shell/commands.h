@@ -21,7 +21,11 @@ int tnosync(int argc, char *argv[]);
 #define MVAR_MAX_WRITERS 10
 
 int mem(int argc, char *argv[]);
+int memprof(int argc, char *argv[]);
+int memtrace(int argc, char *argv[]);
 int ps(int argc, char *argv[]);
+int semstat(int argc, char *argv[]);
+int top(int argc, char *argv[]);
 int loop(int argc, char *argv[]);
 int kill(int argc, char *argv[]);
 int nice(int argc, char *argv[]);
@@ -118,7 +118,15 @@ Command commands[] = {
 	 .isBuiltIn = 0},
 	{.name = "mem",
 	 .func = mem,
-	 .description = "Print memory state",
+	 .description = "Print memory state (-v adds slab caches and profile)",
+	 .isBuiltIn = 0},
+	{.name = "memprof",
+	 .func = memprof,
+	 .description = "Allocation profiler: memprof [on|off|reset]",
+	 .isBuiltIn = 0},
+	{.name = "memtrace",
+	 .func = memtrace,
+	 .description = "Allocation trace to serial: memtrace [on|off|dump]",
 	 .isBuiltIn = 0},
 	{.name = "mvar",
 	 .func = mvar,
@@ -136,6 +144,10 @@ Command commands[] = {
 	 .func = regs,
 	 .description = "Prints the register snapshot, if any",
 	 .isBuiltIn = 0},
+	{.name = "semstat",
+	 .func = semstat,
+	 .description = "Semaphore contention, most contended first: semstat [all]",
+	 .isBuiltIn = 0},
 	{.name = "time",
 	 .func = time,
 	 .description = "Prints the current time",
@@ -144,6 +156,10 @@ Command commands[] = {
 	 .func = testmm,
 	 .description = "Memory manager stress test",
 	 .isBuiltIn = 0},
+	{.name = "top",
+	 .func = top,
+	 .description = "Live process monitor: CPU%, ready wait, switches/s, stack and heap.\n\t\t\t\tUse: top [interval_ms] [iterations]",
+	 .isBuiltIn = 0},
 	{.name = "tproc",
 	 .func = testprocesses,
 	 .description = "Process lifecycle stress test",
@@ -13,6 +13,10 @@ void free(void *ptr);
 
 void *calloc(size_t nmemb, size_t size);
 
+void *realloc(void *ptr, size_t size);
+
+void *aligned_alloc(size_t alignment, size_t size);
+
 int atoi(const char *str);
 
 #endif
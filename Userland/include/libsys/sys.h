@@ -4,6 +4,156 @@
 #include <stdint.h>
 #include <stdint.h>
 
+#define TICKS_PER_SECOND 18
+
+#define PROCESS_NAME_MAX 16
+#define PROCESS_MAX_PROCESSES 32
+/* Kernel ownership header in front of every sys_mem_alloc/sys_mem_map block */
+#define PROCESS_HEAP_HEADER_SIZE 32
+
+#define PROCESS_STATE_READY 0
+#define PROCESS_STATE_RUNNING 1
+#define PROCESS_STATE_BLOCKED 2
+#define PROCESS_STATE_TERMINATED 3
+
+/* Mirrors the kernel's process_info_t filled by processSnapshot */
+typedef struct process_info {
+    uint32_t pid;
+    uint32_t ppid;
+    char name[PROCESS_NAME_MAX];
+    uint8_t state;
+    uint8_t priority;
+    uint8_t foreground;
+    uint64_t cpu_ticks;
+    uint64_t ready_wait_ticks;
+    uint64_t context_switches;
+    uint64_t stack_used;
+    uint64_t stack_size;
+    uint64_t heap_used;
+} process_info_t;
+
+/* Mirrors the kernel's process_self_t returned by sys_process_self */
+typedef struct process_self {
+    uint32_t pid;
+    uint32_t slot;
+    uint64_t serial;
+} process_self_t;
+
+/* futex_wait results, as in the kernel */
+#define FUTEX_WOKEN 0
+#define FUTEX_CHANGED 1
+#define FUTEX_RELEASED 2
+
+#define SEM_TIMEDOUT 1
+
+/*
+ * Mirrors the leading fields of the kernel's sem_t. A semOpen handle points
+ * at them, so semWait and semPost only trap when they must sleep or wake.
+ */
+typedef struct sem_futex {
+    volatile uint32_t count;
+    volatile uint32_t waiters;
+    volatile uint64_t waits;
+    volatile uint64_t posts;
+} sem_futex_t;
+
+#define SEM_NAME_MAX 24
+#define SEM_SNAPSHOT_MAX 128
+
+/* Mirrors the kernel's sem_info_t filled by semSnapshot; times in ticks */
+typedef struct sem_info {
+    char name[SEM_NAME_MAX];
+    uint32_t value;
+    uint32_t waiters;
+    uint64_t waits;
+    uint64_t posts;
+    uint64_t blocked_waits;
+    uint64_t blocked_ticks;
+    uint64_t max_blocked_ticks;
+} sem_info_t;
+
+/* Mirrors the kernel's sync_type_t */
+#define SYNC_MUTEX 0
+#define SYNC_COND 1
+#define SYNC_RWLOCK 2
+#define SYNC_BARRIER 3
+
+/* Mirrors the kernel's pipe capacity limits */
+#define PIPE_DEFAULT_CAPACITY (16 * 1024)
+#define PIPE_MAX_CAPACITY (1024 * 1024)
+
+#define MEM_CACHE_NAME_MAX 16
+#define MEM_CACHE_MAX 16
+
+/* Mirrors the kernel's kmem_cache_info_t filled by memCacheSnapshot */
+typedef struct mem_cache_info {
+    char name[MEM_CACHE_NAME_MAX];
+    uint32_t object_size;
+    uint32_t objects_per_slab;
+    uint32_t slabs;
+    uint32_t partial_slabs;
+    uint32_t active_objects;
+    uint32_t total_objects;
+    uint64_t allocations;
+    uint64_t frees;
+} mem_cache_info_t;
+
+#define MEM_PROFILE_BUCKETS 18
+#define MEM_PROFILE_TOP_SITES 12
+
+#define MEM_TAG_KERNEL 0
+#define MEM_TAG_SCHEDULER 1
+#define MEM_TAG_PROCESS 2
+#define MEM_TAG_SEM 3
+#define MEM_TAG_PIPES 4
+#define MEM_TAG_USER 5
+#define MEM_TAG_COUNT 6
+
+#define MEM_PROFILE_OFF 0
+#define MEM_PROFILE_ON 1
+#define MEM_PROFILE_RESET 2
+
+typedef struct mem_profile_usage {
+    uint64_t live_bytes;
+    uint64_t live_blocks;
+    uint64_t allocations;
+} mem_profile_usage_t;
+
+typedef struct mem_profile_site {
+    uint64_t address;
+    uint32_t tag;
+    uint32_t reserved;
+    mem_profile_usage_t usage;
+} mem_profile_site_t;
+
+/* Mirrors the kernel's mem_profile_info_t filled by memProfileSnapshot */
+typedef struct mem_profile_info {
+    uint8_t enabled;
+    uint32_t site_count;
+    uint64_t ticks;
+    uint64_t allocations;
+    uint64_t frees;
+    uint64_t untracked_frees;
+    uint64_t dropped;
+    uint64_t live_bytes;
+    uint64_t peak_bytes;
+    uint64_t histogram[MEM_PROFILE_BUCKETS];
+    mem_profile_usage_t tags[MEM_TAG_COUNT];
+    mem_profile_site_t sites[MEM_PROFILE_TOP_SITES];
+} mem_profile_info_t;
+
+#define MEM_TRACE_OFF 0
+#define MEM_TRACE_ON 1
+#define MEM_TRACE_DUMP 2
+
+/* Mirrors the kernel's mem_trace_info_t filled by memTraceInfo */
+typedef struct mem_trace_info {
+    uint8_t active;
+    uint32_t capacity;
+    uint64_t records;
+    uint64_t overwritten;
+} mem_trace_info_t;
+
 enum REGISTERABLE_KEYS {
     ESCAPE_KEY        = 0x01,
     KEY_1             = 0x02,
@@ -101,6 +251,7 @@ uint8_t decreaseFontSize(void);
 uint8_t setFontSize(uint8_t size);
 void getDate(int * hour, int * minute, int * second);
 void clearScreen(void);
+void setCursorPosition(uint32_t column, uint32_t row);
 
 
 void drawCircle(uint32_t color, long long int topleftX, long long int topLefyY, long long int diameter);
@@ -113,6 +264,7 @@ void clearScreenCharacter(void);
 int getWindowWidth(void);
 int getWindowHeight(void);
 void sleep(uint32_t milliseconds);
+uint64_t getTicks(void);
 int32_t getRegisterSnapshot(int64_t * registers);
 int32_t processCreate(void (*entry_point)(int argc, char **argv), int argc, char **argv, uint8_t priority, uint8_t foreground);
 int32_t processExit(int32_t status);
@@ -127,15 +279,47 @@ int32_t processWaitPid(uint64_t pid);
 int32_t processWaitChildren(void);
 int32_t processGiveForeground(uint64_t pid);
 int32_t processGetForeground(void);
+int32_t processSnapshot(process_info_t *buffer, uint32_t capacity);
 int32_t openPipe(void);
+/* capacity 0 picks PIPE_DEFAULT_CAPACITY; the buffer is only allocated on the first write */
+int32_t openPipeWithCapacity(uint32_t capacity);
+/* Sets how many bytes the pipe may buffer and returns it; 0 only reports it */
+int32_t resizePipe(uint8_t pipe_id, uint32_t capacity);
 int32_t setFdTargets(uint64_t read_target, uint64_t write_target, uint64_t error_target);
 
 void *semOpen(const char *name, uint32_t initial_count, uint8_t create_if_missing);
 int32_t semClose(void *sem);
 int32_t semWait(void *sem);
 int32_t semPost(void *sem);
+/* 0 once acquired, SEM_TIMEDOUT after ms milliseconds, -1 on error */
+int32_t semTimedWait(void *sem, uint32_t ms);
+int32_t semSnapshot(sem_info_t *buffer, uint32_t capacity);
+
+/* Kernel sync objects: create calls return a handle or -1 */
+int32_t mutexCreate(void);
+int32_t condCreate(void);
+int32_t rwlockCreate(void);
+int32_t barrierCreate(uint32_t parties);
+int32_t syncDestroy(int32_t handle);
+int32_t mutexLock(int32_t mutex);
+/* 0 when taken, 1 when held by someone else */
+int32_t mutexTryLock(int32_t mutex);
+int32_t mutexUnlock(int32_t mutex);
+int32_t condWait(int32_t cond, int32_t mutex);
+int32_t condSignal(int32_t cond);
+int32_t condBroadcast(int32_t cond);
+int32_t rwlockReadLock(int32_t rwlock);
+int32_t rwlockWriteLock(int32_t rwlock);
+int32_t rwlockUnlock(int32_t rwlock);
+/* 1 for the process that completes the round, 0 for the others */
+int32_t barrierWait(int32_t barrier);
 
 int32_t printMemStatus(void);
+int32_t memCacheSnapshot(mem_cache_info_t *buffer, uint32_t capacity);
+int32_t memProfileControl(uint32_t command);
+int32_t memProfileSnapshot(mem_profile_info_t *buffer);
+int64_t memTraceControl(uint32_t command);
+int32_t memTraceInfo(mem_trace_info_t *info);
 
 int32_t clearPipe(uint8_t pipe_id);
 
@@ -27,6 +27,8 @@ int32_t sys_fonts_set_size(uint8_t size);
 int32_t sys_clear_screen(void);
 /* 0x8000000B */
 int32_t sys_clear_screen_character(void);
+/* 0x8000000C */
+int32_t sys_set_cursor_position(uint64_t column, uint64_t row);
 
 // Date syscalls
 /* 0x80000010 */
@@ -44,9 +46,29 @@ int32_t sys_rectangle(int color, long long int width_pixels, long long int heigh
 int32_t sys_fill_video_memory(uint32_t hexColor);
 /* 0x80000024 */
 int32_t sys_mem_status_print(void);
+/* 0x80000025 */
+int32_t sys_mem_cache_snapshot(mem_cache_info_t *buffer, uint64_t capacity);
+/* 0x80000028 */
+int32_t sys_mem_profile_control(uint64_t command);
+/* 0x80000029 */
+int32_t sys_mem_profile_snapshot(mem_profile_info_t *buffer);
+/* 0x8000002A */
+int64_t sys_mem_trace_control(uint64_t command);
+/* 0x8000002B */
+int32_t sys_mem_trace_info(mem_trace_info_t *info);
 
 void *sys_mem_alloc(uint64_t size);
 int32_t sys_mem_free(void *ptr);
+/* 0x80000026 */
+void *sys_mem_map(uint64_t size);
+/* 0x80000027 */
+int32_t sys_mem_unmap(void *chunk);
+/* 0x8000002C */
+void *sys_mem_aligned_alloc(uint64_t align, uint64_t size);
+/* 0x8000002D */
+void *sys_mem_calloc(uint64_t count, uint64_t size);
+/* 0x8000002E */
+void *sys_mem_realloc(void *ptr, uint64_t size);
 
 // Semaphore syscalls
 int64_t sys_sem_open(const char *name, uint32_t initial_count, uint8_t create_if_missing);
@@ -55,6 +77,40 @@ int32_t sys_sem_wait(void *sem);
 int32_t sys_sem_post(void *sem);
 /* 0x80000124 */
 int32_t sys_sem_set_value(void *sem, uint32_t new_value);
+/* 0x80000125 */
+int32_t sys_futex_wait(volatile uint32_t *addr, uint32_t expected);
+/* 0x80000126 */
+int32_t sys_futex_wake(volatile uint32_t *addr, uint32_t count);
+/* 0x80000127 */
+int32_t sys_sem_timedwait(void *sem, uint32_t ms);
+/* 0x80000128 */
+int32_t sys_sem_snapshot(sem_info_t *buffer, uint64_t capacity);
+
+// Sync object syscalls
+/* 0x80000140 */
+int32_t sys_sync_create(uint32_t type, uint32_t barrier_count);
+/* 0x80000141 */
+int32_t sys_sync_destroy(int32_t handle);
+/* 0x80000142 */
+int32_t sys_mutex_lock(int32_t handle);
+/* 0x80000143 */
+int32_t sys_mutex_trylock(int32_t handle);
+/* 0x80000144 */
+int32_t sys_mutex_unlock(int32_t handle);
+/* 0x80000145 */
+int32_t sys_cond_wait(int32_t cond, int32_t mutex);
+/* 0x80000146 */
+int32_t sys_cond_signal(int32_t cond);
+/* 0x80000147 */
+int32_t sys_cond_broadcast(int32_t cond);
+/* 0x80000148 */
+int32_t sys_rwlock_read_lock(int32_t handle);
+/* 0x80000149 */
+int32_t sys_rwlock_write_lock(int32_t handle);
+/* 0x8000014A */
+int32_t sys_rwlock_unlock(int32_t handle);
+/* 0x8000014B */
+int32_t sys_barrier_wait(int32_t handle);
 
 // Process management syscalls
 int32_t sys_process_create(void (*entry_point)(int argc, char **argv), int argc, char **argv, uint8_t priority, uint8_t foreground);
@@ -70,6 +126,10 @@ int32_t sys_process_wait_pid(uint64_t pid);
 int32_t sys_process_wait_children(void);
 int32_t sys_process_give_foreground(uint64_t pid);
 int32_t sys_process_get_foreground(void);
+/* 0x8000010D */
+int32_t sys_process_snapshot(process_info_t *buffer, uint64_t capacity);
+/* 0x8000010E */
+const process_self_t *sys_process_self(void);
 
 // Exec syscall
 int32_t sys_exec(int32_t (*fnPtr)(void));
@@ -84,16 +144,20 @@ int32_t sys_window_height(void);
 
 // Sleep syscall
 int32_t sys_sleep_milis(uint32_t milis);
+/* 0x800000D1 */
+int64_t sys_ticks_elapsed(void);
 
 // Snapshot syscall
 int32_t sys_get_register_snapshot(int64_t * registers);
 
 // Pipe syscalls
 /* 0x80000130 */
-int32_t sys_open_pipe(void);
+int32_t sys_open_pipe(uint32_t capacity);
 /* 0x80000131 */
 int32_t sys_set_fd_targets(uint64_t read_target, uint64_t write_target, uint64_t error_target);
 /* 0x80000132 */
 int32_t sys_clear_pipe(uint64_t pipe_id);
+/* 0x80000133 */
+int32_t sys_resize_pipe(uint64_t pipe_id, uint32_t capacity);
 
 #endif
@@ -0,0 +1,353 @@
+// This is a personal academic project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+#include <stdlib.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <syscalls.h>
+
+/*
+ * Userland heap. Small requests are served from per-process arenas carved
+ * out of ARENA_CHUNK_SIZE chunks granted by the kernel, so the common
+ * malloc/free pair never leaves userland. Every process shares this image,
+ * so arenas are indexed by the process table slot and tagged with the
+ * process serial: a slot reused by a new process starts from an empty
+ * arena, and the kernel releases the old chunks when the owner exits.
+ * Chunks come zeroed from sys_mem_calloc, so objects carved from fresh
+ * bump space need no clearing in calloc.
+ */
+
+/* Chunks plus the kernel's ownership header still fit a 64 KiB block */
+#define ARENA_CHUNK_SIZE (64 * 1024 - PROCESS_HEAP_HEADER_SIZE)
+#define REMOTE_FREE_SLOTS 32
+#define SIZE_CLASS_COUNT 14
+#define LARGE_CLASS 0xFF
+
+#define BLOCK_ALLOCATED 0xA110
+#define BLOCK_FREE 0xF4EE
+
+static const uint32_t size_classes[SIZE_CLASS_COUNT] = {
+    16, 32, 48, 64, 96, 128, 192, 256, 384, 512, 768, 1024, 1536, 2048
+};
+
+/* Sits right before every pointer handed out */
+typedef struct block_header {
+    uint32_t serial;
+    uint8_t slot;
+    uint8_t size_class;
+    uint16_t state;
+} block_header_t;
+
+/*
+ * Large blocks get their own chunk; the usable size goes in front of the
+ * header. offset is the padding between the chunk and this struct, which
+ * aligned_alloc uses to push the payload onto its boundary.
+ */
+typedef struct large_block {
+    uint32_t size;
+    uint32_t offset;
+    block_header_t header;
+} large_block_t;
+
+typedef struct free_object {
+    struct free_object *next;
+} free_object_t;
+
+typedef struct arena {
+    uint64_t serial;
+    free_object_t *free_lists[SIZE_CLASS_COUNT];
+    /*
+     * Objects freed by other processes. They are parked here instead of
+     * being linked through the object itself, because the owner may have
+     * exited and released the chunk under the freeing process.
+     */
+    void *volatile remote_frees[REMOTE_FREE_SLOTS];
+    volatile uint32_t remote_pending;
+    uint8_t *bump;
+    uint8_t *bump_end;
+} arena_t;
+
+static arena_t arenas[PROCESS_MAX_PROCESSES];
+static const process_self_t *self = NULL;
+
+static block_header_t *header_of(void *ptr) {
+    return (block_header_t *)ptr - 1;
+}
+
+static int size_class_of(size_t size) {
+    for (int i = 0; i < SIZE_CLASS_COUNT; i++) {
+        if (size <= size_classes[i]) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+static arena_t *current_arena(void) {
+    if (self == NULL) {
+        self = sys_process_self();
+        if (self == NULL) {
+            return NULL;
+        }
+    }
+
+    uint32_t slot = self->slot;
+    uint64_t serial = self->serial;
+    if (serial == 0 || slot >= PROCESS_MAX_PROCESSES) {
+        return NULL;
+    }
+
+    arena_t *arena = &arenas[slot];
+    if (arena->serial != serial) {
+        memset(arena, 0, sizeof(arena_t));
+        arena->serial = serial;
+    }
+    return arena;
+}
+
+static void push_free(arena_t *arena, block_header_t *header) {
+    free_object_t *object = (free_object_t *)(header + 1);
+    object->next = arena->free_lists[header->size_class];
+    arena->free_lists[header->size_class] = object;
+}
+
+static void drain_remote_frees(arena_t *arena) {
+    uint32_t drained = 0;
+    for (int i = 0; i < REMOTE_FREE_SLOTS; i++) {
+        void *object = __sync_lock_test_and_set(&arena->remote_frees[i], NULL);
+        if (object == NULL) {
+            continue;
+        }
+        drained++;
+        block_header_t *header = header_of(object);
+        if (header->serial == (uint32_t)arena->serial && header->state == BLOCK_ALLOCATED) {
+            header->state = BLOCK_FREE;
+            push_free(arena, header);
+        }
+    }
+    __sync_fetch_and_sub(&arena->remote_pending, drained);
+}
+
+/* align 0 means no alignment beyond what the kernel gives */
+static void *malloc_large(arena_t *arena, size_t size, size_t align, int zeroed) {
+    size_t lead = sizeof(large_block_t);
+    if (align > lead) {
+        lead = align;
+    }
+    if (size > UINT32_MAX || size > SIZE_MAX - lead) {
+        return NULL;
+    }
+
+    uint8_t *chunk;
+    if (align != 0) {
+        chunk = sys_mem_aligned_alloc(align, lead + size);
+    } else if (zeroed) {
+        chunk = sys_mem_calloc(1, lead + size);
+    } else {
+        chunk = sys_mem_map(lead + size);
+    }
+    if (chunk == NULL) {
+        return NULL;
+    }
+
+    large_block_t *block = (large_block_t *)(chunk + lead) - 1;
+    block->size = (uint32_t)size;
+    block->offset = (uint32_t)(lead - sizeof(large_block_t));
+    block->header.serial = (uint32_t)arena->serial;
+    block->header.slot = (uint8_t)(arena - arenas);
+    block->header.size_class = LARGE_CLASS;
+    block->header.state = BLOCK_ALLOCATED;
+    return &block->header + 1;
+}
+
+/* Sets *fresh when the object comes from bump space, which is still zeroed */
+static void *malloc_small(arena_t *arena, int size_class, int *fresh) {
+    if (arena->free_lists[size_class] == NULL && arena->remote_pending != 0) {
+        drain_remote_frees(arena);
+    }
+
+    block_header_t *header;
+    free_object_t *object = arena->free_lists[size_class];
+    if (object != NULL) {
+        arena->free_lists[size_class] = object->next;
+        header = header_of(object);
+        *fresh = 0;
+    } else {
+        size_t block_size = sizeof(block_header_t) + size_classes[size_class];
+        if (arena->bump == NULL || (size_t)(arena->bump_end - arena->bump) < block_size) {
+            uint8_t *chunk = sys_mem_calloc(1, ARENA_CHUNK_SIZE);
+            if (chunk == NULL) {
+                return NULL;
+            }
+            arena->bump = chunk;
+            arena->bump_end = chunk + ARENA_CHUNK_SIZE;
+        }
+        header = (block_header_t *)arena->bump;
+        arena->bump += block_size;
+        header->serial = (uint32_t)arena->serial;
+        header->slot = (uint8_t)(arena - arenas);
+        header->size_class = (uint8_t)size_class;
+        *fresh = 1;
+    }
+
+    header->state = BLOCK_ALLOCATED;
+    return header + 1;
+}
+
+void *malloc(size_t size) {
+    if (size == 0) {
+        return NULL;
+    }
+
+    arena_t *arena = current_arena();
+    if (arena == NULL) {
+        return NULL;
+    }
+
+    int size_class = size_class_of(size);
+    if (size_class < 0) {
+        return malloc_large(arena, size, 0, 0);
+    }
+
+    int fresh;
+    return malloc_small(arena, size_class, &fresh);
+}
+
+/*
+ * Arena objects are only as aligned as their 8-byte header allows, so
+ * stricter alignments go to the kernel, which pads the chunk for us.
+ */
+void *aligned_alloc(size_t alignment, size_t size) {
+    if (alignment == 0 || (alignment & (alignment - 1)) != 0) {
+        return NULL;
+    }
+    if (alignment <= sizeof(block_header_t)) {
+        return malloc(size);
+    }
+    if (size == 0) {
+        return NULL;
+    }
+
+    arena_t *arena = current_arena();
+    if (arena == NULL) {
+        return NULL;
+    }
+    return malloc_large(arena, size, alignment, 0);
+}
+
+void free(void *ptr) {
+    if (ptr == NULL) {
+        return;
+    }
+
+    block_header_t *header = header_of(ptr);
+    if (header->state != BLOCK_ALLOCATED || header->slot >= PROCESS_MAX_PROCESSES) {
+        return;
+    }
+
+    if (header->size_class == LARGE_CLASS) {
+        /* The kernel checks ownership and ignores blocks already released */
+        large_block_t *block = (large_block_t *)((uint8_t *)ptr - sizeof(large_block_t));
+        sys_mem_unmap((uint8_t *)block - block->offset);
+        return;
+    }
+
+    arena_t *arena = current_arena();
+    arena_t *owner = &arenas[header->slot];
+    if (arena == owner && (uint32_t)arena->serial == header->serial) {
+        header->state = BLOCK_FREE;
+        push_free(arena, header);
+        return;
+    }
+
+    /* Owner gone: its chunks went back to the kernel when it exited */
+    if ((uint32_t)owner->serial != header->serial) {
+        return;
+    }
+
+    /* A full mailbox only delays the block until the owner exits */
+    for (int i = 0; i < REMOTE_FREE_SLOTS; i++) {
+        if (__sync_bool_compare_and_swap(&owner->remote_frees[i], NULL, ptr)) {
+            __sync_fetch_and_add(&owner->remote_pending, 1);
+            return;
+        }
+    }
+}
+
+static size_t usable_size(void *ptr) {
+    block_header_t *header = header_of(ptr);
+    if (header->size_class == LARGE_CLASS) {
+        return ((large_block_t *)((uint8_t *)ptr - sizeof(large_block_t)))->size;
+    }
+    return size_classes[header->size_class];
+}
+
+void *realloc(void *ptr, size_t size) {
+    if (ptr == NULL) {
+        return malloc(size);
+    }
+
+    if (size == 0) {
+        free(ptr);
+        return NULL;
+    }
+
+    /* Unaligned large blocks are resized by the kernel, in place when it can */
+    block_header_t *header = header_of(ptr);
+    if (header->size_class == LARGE_CLASS && header->state == BLOCK_ALLOCATED) {
+        large_block_t *block = (large_block_t *)((uint8_t *)ptr - sizeof(large_block_t));
+        if (block->offset == 0 && size <= UINT32_MAX - sizeof(large_block_t)) {
+            large_block_t *resized = sys_mem_realloc(block, sizeof(large_block_t) + size);
+            if (resized == NULL) {
+                return NULL;
+            }
+            resized->size = (uint32_t)size;
+            return &resized->header + 1;
+        }
+    }
+
+    size_t capacity = usable_size(ptr);
+    if (size <= capacity) {
+        return ptr;
+    }
+
+    uint8_t *resized = malloc(size);
+    if (resized == NULL) {
+        return NULL;
+    }
+
+    uint8_t *source = ptr;
+    for (size_t i = 0; i < capacity; i++) {
+        resized[i] = source[i];
+    }
+    free(ptr);
+    return resized;
+}
+
+void *calloc(size_t nmemb, size_t size) {
+    if (nmemb == 0 || size == 0) {
+        return NULL;
+    }
+
+    if (nmemb > SIZE_MAX / size) {
+        return NULL;
+    }
+
+    size_t total = nmemb * size;
+    arena_t *arena = current_arena();
+    if (arena == NULL) {
+        return NULL;
+    }
+
+    int size_class = size_class_of(total);
+    if (size_class < 0) {
+        return malloc_large(arena, total, 0, 1);
+    }
+
+    int fresh;
+    void *ptr = malloc_small(arena, size_class, &fresh);
+    if (ptr != NULL && !fresh) {
+        memset(ptr, 0, total);
+    }
+    return ptr;
+}
@@ -8,25 +8,53 @@ GLOBAL sys_fonts_increase_size
 GLOBAL sys_fonts_set_size
 GLOBAL sys_clear_screen
 GLOBAL sys_clear_screen_character
+GLOBAL sys_set_cursor_position
 
 GLOBAL sys_hour
 GLOBAL sys_minute
 GLOBAL sys_second
 GLOBAL sys_sleep_milis
+GLOBAL sys_ticks_elapsed
 
 GLOBAL sys_circle
 GLOBAL sys_rectangle
 GLOBAL sys_fill_video_memory
 GLOBAL sys_mem_status_print
+GLOBAL sys_mem_cache_snapshot
+GLOBAL sys_mem_profile_control
+GLOBAL sys_mem_profile_snapshot
+GLOBAL sys_mem_trace_control
+GLOBAL sys_mem_trace_info
 
 GLOBAL sys_mem_alloc
 GLOBAL sys_mem_free
+GLOBAL sys_mem_map
+GLOBAL sys_mem_unmap
+GLOBAL sys_mem_aligned_alloc
+GLOBAL sys_mem_calloc
+GLOBAL sys_mem_realloc
 
 GLOBAL sys_sem_open
 GLOBAL sys_sem_close
 GLOBAL sys_sem_wait
 GLOBAL sys_sem_post
 GLOBAL sys_sem_set_value
+GLOBAL sys_futex_wait
+GLOBAL sys_futex_wake
+GLOBAL sys_sem_timedwait
+GLOBAL sys_sem_snapshot
+GLOBAL sys_sync_create
+GLOBAL sys_sync_destroy
+GLOBAL sys_mutex_lock
+GLOBAL sys_mutex_trylock
+GLOBAL sys_mutex_unlock
+GLOBAL sys_cond_wait
+GLOBAL sys_cond_signal
+GLOBAL sys_cond_broadcast
+GLOBAL sys_rwlock_read_lock
+GLOBAL sys_rwlock_write_lock
+GLOBAL sys_rwlock_unlock
+GLOBAL sys_barrier_wait
 
 GLOBAL sys_process_create
 GLOBAL sys_process_exit
@@ -41,6 +69,8 @@ GLOBAL sys_process_wait_pid
 GLOBAL sys_process_wait_children
 GLOBAL sys_process_give_foreground
 GLOBAL sys_process_get_foreground
+GLOBAL sys_process_snapshot
+GLOBAL sys_process_self
 
 GLOBAL sys_exec
 
@@ -54,6 +84,7 @@ GLOBAL sys_get_register_snapshot
 GLOBAL sys_open_pipe
 GLOBAL sys_set_fd_targets
 GLOBAL sys_clear_pipe
+GLOBAL sys_resize_pipe
 
 section .text
 
@@ -80,6 +111,7 @@ sys_fonts_increase_size: sys_int80 0x80000008
 sys_fonts_set_size: sys_int80 0x80000009
 sys_clear_screen: sys_int80 0x8000000A
 sys_clear_screen_character: sys_int80 0x8000000B
+sys_set_cursor_position: sys_int80 0x8000000C
 
 
 sys_hour: sys_int80 0x80000010
@@ -90,15 +122,41 @@ sys_circle: sys_int80 0x80000019
 sys_rectangle: sys_int80 0x80000020
 sys_fill_video_memory: sys_int80 0x80000021
 sys_mem_status_print: sys_int80 0x80000024
+sys_mem_cache_snapshot: sys_int80 0x80000025
+sys_mem_profile_control: sys_int80 0x80000028
+sys_mem_profile_snapshot: sys_int80 0x80000029
+sys_mem_trace_control: sys_int80 0x8000002A
+sys_mem_trace_info: sys_int80 0x8000002B
 
 sys_mem_alloc: sys_int80 0x80000022
 sys_mem_free: sys_int80 0x80000023
+sys_mem_map: sys_int80 0x80000026
+sys_mem_unmap: sys_int80 0x80000027
+sys_mem_aligned_alloc: sys_int80 0x8000002C
+sys_mem_calloc: sys_int80 0x8000002D
+sys_mem_realloc: sys_int80 0x8000002E
 
 sys_sem_open: sys_int80 0x80000120
 sys_sem_close: sys_int80 0x80000121
 sys_sem_wait: sys_int80 0x80000122
 sys_sem_post: sys_int80 0x80000123
 sys_sem_set_value: sys_int80 0x80000124
+sys_futex_wait: sys_int80 0x80000125
+sys_futex_wake: sys_int80 0x80000126
+sys_sem_timedwait: sys_int80 0x80000127
+sys_sem_snapshot: sys_int80 0x80000128
+sys_sync_create: sys_int80 0x80000140
+sys_sync_destroy: sys_int80 0x80000141
+sys_mutex_lock: sys_int80 0x80000142
+sys_mutex_trylock: sys_int80 0x80000143
+sys_mutex_unlock: sys_int80 0x80000144
+sys_cond_wait: sys_int80 0x80000145
+sys_cond_signal: sys_int80 0x80000146
+sys_cond_broadcast: sys_int80 0x80000147
+sys_rwlock_read_lock: sys_int80 0x80000148
+sys_rwlock_write_lock: sys_int80 0x80000149
+sys_rwlock_unlock: sys_int80 0x8000014A
+sys_barrier_wait: sys_int80 0x8000014B
 
 sys_process_create: sys_int80 0x80000100
 sys_process_exit: sys_int80 0x80000101
@@ -113,6 +171,8 @@ sys_process_wait_pid: sys_int80 0x80000109
 sys_process_wait_children: sys_int80 0x8000010A
 sys_process_give_foreground: sys_int80 0x8000010B
 sys_process_get_foreground: sys_int80 0x8000010C
+sys_process_snapshot: sys_int80 0x8000010D
+sys_process_self: sys_int80 0x8000010E
 
 sys_exec: sys_int80 0x800000A0
 
@@ -122,9 +182,11 @@ sys_window_width: sys_int80 0x800000C0
 sys_window_height: sys_int80 0x800000C1
 
 sys_sleep_milis: sys_int80 0x800000D0
+sys_ticks_elapsed: sys_int80 0x800000D1
 
 sys_get_register_snapshot: sys_int80 0x800000E0
 
 sys_open_pipe: sys_int80 0x80000130
 sys_set_fd_targets: sys_int80 0x80000131
-sys_clear_pipe: sys_int80 0x80000132
\ No newline at end of file
+sys_clear_pipe: sys_int80 0x80000132
+sys_resize_pipe: sys_int80 0x80000133
\ No newline at end of file
@@ -1,5 +1,6 @@
 // This is a personal academic project. Dear PVS-Studio, please check it.
 // PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+#include <stddef.h>
 #include <sys.h>
 #include <syscalls.h>
 
@@ -45,6 +46,10 @@ void clearScreenCharacter(void) {
     sys_clear_screen_character();
 }
 
+void setCursorPosition(uint32_t column, uint32_t row) {
+    sys_set_cursor_position(column, row);
+}
+
 void drawCircle(uint32_t color, long long int topleftX, long long int topLefyY, long long int diameter) {
     sys_circle(color, topleftX, topLefyY, diameter);
 }
@@ -78,6 +83,10 @@ void sleep(uint32_t miliseconds) {
     sys_sleep_milis(miliseconds);
 }
 
+uint64_t getTicks(void) {
+    return (uint64_t)sys_ticks_elapsed();
+}
+
 int32_t getRegisterSnapshot(int64_t * registers) {
     return sys_get_register_snapshot(registers);
 }
@@ -134,8 +143,20 @@ int32_t processGetForeground(void) {
     return sys_process_get_foreground();
 }
 
+int32_t processSnapshot(process_info_t *buffer, uint32_t capacity) {
+    return sys_process_snapshot(buffer, capacity);
+}
+
 int32_t openPipe(void) {
-    return sys_open_pipe();
+    return sys_open_pipe(0);
+}
+
+int32_t openPipeWithCapacity(uint32_t capacity) {
+    return sys_open_pipe(capacity);
+}
+
+int32_t resizePipe(uint8_t pipe_id, uint32_t capacity) {
+    return sys_resize_pipe(pipe_id, capacity);
 }
 
 int32_t setFdTargets(uint64_t read_target, uint64_t write_target, uint64_t error_target) {
@@ -150,18 +171,142 @@ int32_t semClose(void *sem) {
     return sys_sem_close(sem);
 }
 
+/* Single incq, so no interrupt splits it; the kernel counts the same way */
+static inline void semStatIncrement(volatile uint64_t *counter) {
+    __asm__ volatile("incq %0" : "+m"(*counter));
+}
+
+static int semTryTake(sem_futex_t *futex) {
+    uint32_t count = futex->count;
+    while (count > 0) {
+        if (__sync_bool_compare_and_swap(&futex->count, count, count - 1)) {
+            semStatIncrement(&futex->waits);
+            return 1;
+        }
+        count = futex->count;
+    }
+    return 0;
+}
+
+/* The kernel takes over once the semaphore is empty, to sleep and time the wait */
 int32_t semWait(void *sem) {
-    return sys_sem_wait(sem);
+    sem_futex_t *futex = sem;
+    if (futex == NULL) {
+        return -1;
+    }
+    return semTryTake(futex) ? 0 : sys_sem_wait(sem);
 }
 
 int32_t semPost(void *sem) {
-    return sys_sem_post(sem);
+    sem_futex_t *futex = sem;
+    if (futex == NULL) {
+        return -1;
+    }
+
+    __sync_fetch_and_add(&futex->count, 1);
+    semStatIncrement(&futex->posts);
+    if (futex->waiters != 0) {
+        sys_futex_wake(&futex->count, 1);
+    }
+    return 0;
+}
+
+int32_t semTimedWait(void *sem, uint32_t ms) {
+    sem_futex_t *futex = sem;
+    if (futex == NULL) {
+        return -1;
+    }
+    return semTryTake(futex) ? 0 : sys_sem_timedwait(sem, ms);
+}
+
+int32_t semSnapshot(sem_info_t *buffer, uint32_t capacity) {
+    return sys_sem_snapshot(buffer, capacity);
+}
+
+int32_t mutexCreate(void) {
+    return sys_sync_create(SYNC_MUTEX, 0);
+}
+
+int32_t condCreate(void) {
+    return sys_sync_create(SYNC_COND, 0);
+}
+
+int32_t rwlockCreate(void) {
+    return sys_sync_create(SYNC_RWLOCK, 0);
+}
+
+int32_t barrierCreate(uint32_t parties) {
+    return sys_sync_create(SYNC_BARRIER, parties);
+}
+
+int32_t syncDestroy(int32_t handle) {
+    return sys_sync_destroy(handle);
+}
+
+int32_t mutexLock(int32_t mutex) {
+    return sys_mutex_lock(mutex);
+}
+
+int32_t mutexTryLock(int32_t mutex) {
+    return sys_mutex_trylock(mutex);
+}
+
+int32_t mutexUnlock(int32_t mutex) {
+    return sys_mutex_unlock(mutex);
+}
+
+int32_t condWait(int32_t cond, int32_t mutex) {
+    return sys_cond_wait(cond, mutex);
+}
+
+int32_t condSignal(int32_t cond) {
+    return sys_cond_signal(cond);
+}
+
+int32_t condBroadcast(int32_t cond) {
+    return sys_cond_broadcast(cond);
+}
+
+int32_t rwlockReadLock(int32_t rwlock) {
+    return sys_rwlock_read_lock(rwlock);
+}
+
+int32_t rwlockWriteLock(int32_t rwlock) {
+    return sys_rwlock_write_lock(rwlock);
+}
+
+int32_t rwlockUnlock(int32_t rwlock) {
+    return sys_rwlock_unlock(rwlock);
+}
+
+int32_t barrierWait(int32_t barrier) {
+    return sys_barrier_wait(barrier);
 }
 
 int32_t printMemStatus(void) {
     return sys_mem_status_print();
 }
 
+int32_t memCacheSnapshot(mem_cache_info_t *buffer, uint32_t capacity) {
+    return sys_mem_cache_snapshot(buffer, capacity);
+}
+
+int32_t memProfileControl(uint32_t command) {
+    return sys_mem_profile_control(command);
+}
+
+int32_t memProfileSnapshot(mem_profile_info_t *buffer) {
+    return sys_mem_profile_snapshot(buffer);
+}
+
+int64_t memTraceControl(uint32_t command) {
+    return sys_mem_trace_control(command);
+}
+
+int32_t memTraceInfo(mem_trace_info_t *info) {
+    return sys_mem_trace_info(info);
+}
+
 int32_t clearPipe(uint8_t pipe_id) {
     return sys_clear_pipe(pipe_id);
 }
@@ -5,9 +5,11 @@
 
 #include <test.h>
 #include <sys.h>
+#include <syscalls.h>
 #include "test_util.h"
 
 #define TOTAL_PAIR_PROCESSES 2
+#define UNCONTENDED_ROUNDS 10000
 #define PROCESS_PRIORITY_DEFAULT 2
 #define PROCESS_FOREGROUND 1
 
@@ -51,6 +53,34 @@ static void process_inc(int argc, char **argv) {
     processExit(0);
 }
 
+static uint64_t read_cycles(void) {
+    uint32_t low, high;
+    __asm__ volatile("rdtsc" : "=a"(low), "=d"(high));
+    return ((uint64_t)high << 32) | low;
+}
+
+/*
+ * Average cycles of one wait+post pair on a free semaphore, through the
+ * libsys fast path and through the sem syscalls, which always trap.
+ */
+static void measure_uncontended(void *sem) {
+    uint64_t start = read_cycles();
+    for (int i = 0; i < UNCONTENDED_ROUNDS; i++) {
+        semWait(sem);
+        semPost(sem);
+    }
+    uint64_t fast = (read_cycles() - start) / UNCONTENDED_ROUNDS;
+
+    start = read_cycles();
+    for (int i = 0; i < UNCONTENDED_ROUNDS; i++) {
+        sys_sem_wait(sem);
+        sys_sem_post(sem);
+    }
+    uint64_t trapping = (read_cycles() - start) / UNCONTENDED_ROUNDS;
+
+    printf("Uncontended wait+post: %d cycles (syscall: %d cycles)\n", (int)fast, (int)trapping);
+}
+
 static uint64_t run_sync_test(uint64_t iterations, uint8_t use_sem) {
     int32_t pids[2 * TOTAL_PAIR_PROCESSES];
     char iterations_str[24];
@@ -124,6 +154,7 @@ uint64_t test_sync(uint64_t argc, char *argv[]) {
         return (uint64_t)-1;
     }
 
+    measure_uncontended(sync_sem);
     uint64_t result = run_sync_test((uint64_t)iterations, 1);
 
     semClose(sync_sem);
@@ -1,6 +1,7 @@
 # Validates the existance of the TPE-ARQ container, starts it up & compiles the project
 CONTAINER_NAME="TPE-ARQ-g08-64018-64288-64646"
 MEMORY_MANAGER=${1:-buddy}
+QUEUE_IMPL=${2:-ring}
 EXTRA_WARNINGS="-Wall"
 
 # COLORS
@@ -40,7 +41,7 @@ HOST_GID=$(id -g)
 
 docker exec -u "$HOST_UID:$HOST_GID" -it "$CONTAINER_NAME" make clean -C /root/ && \
 docker exec -u "$HOST_UID:$HOST_GID" -it "$CONTAINER_NAME" make all -C /root/Toolchain EXTRA_WARNINGS="$EXTRA_WARNINGS" && \
-docker exec -u "$HOST_UID:$HOST_GID" -it "$CONTAINER_NAME" make all -C /root/ MEMORY_MANAGER="$MEMORY_MANAGER" EXTRA_WARNINGS="$EXTRA_WARNINGS"
+docker exec -u "$HOST_UID:$HOST_GID" -it "$CONTAINER_NAME" make all -C /root/ MEMORY_MANAGER="$MEMORY_MANAGER" QUEUE_IMPL="$QUEUE_IMPL" EXTRA_WARNINGS="$EXTRA_WARNINGS"
 
 
 if [ $? -ne 0 ]; then
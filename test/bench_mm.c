@@ -0,0 +1,249 @@
+// This is a personal academic project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+/*
+ * Native benchmark for the kernel allocators. Each workload keeps a bounded
+ * set of live blocks, times every mem_alloc/mem_free with rdtsc and samples
+ * the allocator's own counters after every operation. Results are printed
+ * as a table or, with --csv, as one CSV row per workload.
+ */
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+#include <memoryManager.h>
+#include "test_util.h"
+
+#define BENCH_SLOTS 256
+#define BENCH_DEFAULT_OPS 200000
+
+typedef enum {
+  ORDER_RANDOM,
+  ORDER_FIFO,
+  ORDER_LIFO
+} order_t;
+
+typedef struct {
+  const char *name;
+  uint32_t (*next_size)(void);
+  order_t order;
+} workload_t;
+
+typedef struct {
+  uint64_t *samples;
+  uint64_t count;
+} latency_t;
+
+typedef struct {
+  double ops_per_sec;
+  uint64_t alloc_p50;
+  uint64_t alloc_p99;
+  uint64_t free_p50;
+  uint64_t free_p99;
+  double peak_fragmentation;
+  double failure_rate;
+} result_t;
+
+static void *slots[BENCH_SLOTS];
+
+static inline uint64_t cycles(void) {
+  uint32_t lo, hi;
+  __asm__ volatile("rdtsc" : "=a"(lo), "=d"(hi));
+  return ((uint64_t)hi << 32) | lo;
+}
+
+static double tsc_hz = 0.0;
+
+static double seconds_now(void) {
+  struct timeval now;
+  gettimeofday(&now, NULL);
+  return (double)now.tv_sec + (double)now.tv_usec / 1e6;
+}
+
+/* ops/sec comes from the same rdtsc samples, so the TSC rate is measured once */
+static void calibrate_tsc(void) {
+  double start = seconds_now();
+  uint64_t start_cycles = cycles();
+  while (seconds_now() - start < 0.05) {
+  }
+  tsc_hz = (double)(cycles() - start_cycles) / (seconds_now() - start);
+}
+
+static int compare_u64(const void *a, const void *b) {
+  uint64_t x = *(const uint64_t *)a;
+  uint64_t y = *(const uint64_t *)b;
+  return (x > y) - (x < y);
+}
+
+static uint64_t percentile(latency_t *latency, int pct) {
+  if (latency->count == 0) {
+    return 0;
+  }
+  return latency->samples[(latency->count - 1) * pct / 100];
+}
+
+/* External fragmentation: share of free memory outside the largest free block */
+static double fragmentation(void) {
+  mem_stats_t stats;
+  mem_get_stats(&stats);
+  if (stats.free == 0) {
+    return 0.0;
+  }
+  return 100.0 * (double)(stats.free - stats.largest_free) / (double)stats.free;
+}
+
+static uint32_t uniform_size(void) {
+  return GetUniform(4095) + 1;
+}
+
+static uint32_t small_size(void) {
+  return GetUniform(127) + 1;
+}
+
+static uint32_t power_of_two_size(void) {
+  return 1u << (5 + GetUniform(9));
+}
+
+static const workload_t workloads[] = {
+  {"uniform", uniform_size, ORDER_RANDOM},
+  {"small", small_size, ORDER_RANDOM},
+  {"power-of-two", power_of_two_size, ORDER_RANDOM},
+  {"producer-consumer", uniform_size, ORDER_FIFO},
+  {"stack-like", uniform_size, ORDER_LIFO},
+};
+
+/* Picks the slot to touch next; an empty slot is allocated, a full one freed */
+static int next_slot(const workload_t *workload, int *head, int *live) {
+  switch (workload->order) {
+    case ORDER_FIFO: {
+      int produce = *live == 0 || (*live < BENCH_SLOTS && GetUniform(2) == 0);
+      return produce ? (*head + *live) % BENCH_SLOTS : *head;
+    }
+    case ORDER_LIFO: {
+      int push = *live == 0 || (*live < BENCH_SLOTS && GetUniform(2) == 0);
+      return push ? *live : *live - 1;
+    }
+    default:
+      return (int)GetUniform(BENCH_SLOTS - 1);
+  }
+}
+
+static void run_workload(const workload_t *workload, uint64_t ops, result_t *result) {
+  latency_t alloc_latency = {malloc(ops * sizeof(uint64_t)), 0};
+  latency_t free_latency = {malloc(ops * sizeof(uint64_t)), 0};
+  uint64_t failures = 0;
+  double peak_fragmentation = 0.0;
+  uint64_t timed = 0;
+  int head = 0;
+  int live = 0;
+
+  if (alloc_latency.samples == NULL || free_latency.samples == NULL) {
+    fprintf(stderr, "bench_mm: out of host memory\n");
+    exit(1);
+  }
+
+  memset(slots, 0, sizeof(slots));
+  mem_init();
+
+  for (uint64_t op = 0; op < ops; op++) {
+    int slot = next_slot(workload, &head, &live);
+
+    if (slots[slot] == NULL) {
+      uint32_t size = workload->next_size();
+      uint64_t start = cycles();
+      slots[slot] = mem_alloc(size);
+      uint64_t elapsed = cycles() - start;
+      alloc_latency.samples[alloc_latency.count++] = elapsed;
+      timed += elapsed;
+      if (slots[slot] == NULL) {
+        failures++;
+      } else if (workload->order != ORDER_RANDOM) {
+        live++;
+      }
+    } else {
+      uint64_t start = cycles();
+      mem_free(slots[slot]);
+      uint64_t elapsed = cycles() - start;
+      free_latency.samples[free_latency.count++] = elapsed;
+      timed += elapsed;
+      slots[slot] = NULL;
+      if (workload->order == ORDER_FIFO) {
+        head = (head + 1) % BENCH_SLOTS;
+        live--;
+      } else if (workload->order == ORDER_LIFO) {
+        live--;
+      }
+    }
+
+    double current = fragmentation();
+    if (current > peak_fragmentation) {
+      peak_fragmentation = current;
+    }
+  }
+
+  for (int i = 0; i < BENCH_SLOTS; i++) {
+    mem_free(slots[i]);
+  }
+
+  qsort(alloc_latency.samples, alloc_latency.count, sizeof(uint64_t), compare_u64);
+  qsort(free_latency.samples, free_latency.count, sizeof(uint64_t), compare_u64);
+
+  result->ops_per_sec = timed > 0 ? (double)ops * tsc_hz / (double)timed : 0.0;
+  result->alloc_p50 = percentile(&alloc_latency, 50);
+  result->alloc_p99 = percentile(&alloc_latency, 99);
+  result->free_p50 = percentile(&free_latency, 50);
+  result->free_p99 = percentile(&free_latency, 99);
+  result->peak_fragmentation = peak_fragmentation;
+  result->failure_rate = alloc_latency.count ? 100.0 * (double)failures / (double)alloc_latency.count : 0.0;
+
+  free(alloc_latency.samples);
+  free(free_latency.samples);
+}
+
+int main(int argc, char *argv[]) {
+  const char *allocator = "allocator";
+  uint64_t ops = BENCH_DEFAULT_OPS;
+  int csv = 0;
+  int header = 1;
+
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--csv") == 0) {
+      csv = 1;
+    } else if (strcmp(argv[i], "--no-header") == 0) {
+      header = 0;
+    } else if (argv[i][0] >= '0' && argv[i][0] <= '9') {
+      ops = satoi(argv[i]);
+    } else {
+      allocator = argv[i];
+    }
+  }
+
+  calibrate_tsc();
+
+  if (header) {
+    if (csv) {
+      printf("allocator,workload,ops_per_sec,alloc_p50,alloc_p99,free_p50,free_p99,peak_frag_pct,failure_pct\n");
+    } else {
+      printf("%-9s %-17s %12s %9s %9s %9s %9s %9s %8s\n", "allocator", "workload", "ops/sec",
+             "alloc p50", "alloc p99", "free p50", "free p99", "peak frag", "failed");
+    }
+  }
+
+  for (size_t i = 0; i < sizeof(workloads) / sizeof(workloads[0]); i++) {
+    result_t result;
+    run_workload(&workloads[i], ops, &result);
+    if (csv) {
+      printf("%s,%s,%.0f,%llu,%llu,%llu,%llu,%.1f,%.2f\n", allocator, workloads[i].name, result.ops_per_sec,
+             (unsigned long long)result.alloc_p50, (unsigned long long)result.alloc_p99,
+             (unsigned long long)result.free_p50, (unsigned long long)result.free_p99,
+             result.peak_fragmentation, result.failure_rate);
+    } else {
+      printf("%-9s %-17s %12.0f %9llu %9llu %9llu %9llu %8.1f%% %7.2f%%\n", allocator, workloads[i].name,
+             result.ops_per_sec, (unsigned long long)result.alloc_p50, (unsigned long long)result.alloc_p99,
+             (unsigned long long)result.free_p50, (unsigned long long)result.free_p99,
+             result.peak_fragmentation, result.failure_rate);
+    }
+  }
+
+  return 0;
+}
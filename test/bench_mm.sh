@@ -0,0 +1,38 @@
+#!/bin/bash
+# Builds and runs the native allocator benchmark against each memory manager.
+# Usage: ./bench_mm.sh [all|buddy|mymalloc|tlsf] [operations] [--csv]
+# Latencies are in cycles, fragmentation is the peak share of free memory
+# outside the largest free block.
+
+MEMORY_MANAGER=${1:-all}
+OPERATIONS=${2:-200000}
+FORMAT=$3
+
+case "$MEMORY_MANAGER" in
+    all) MANAGERS="buddy mymalloc tlsf" ;;
+    buddy|mymalloc|tlsf) MANAGERS=$MEMORY_MANAGER ;;
+    *)
+        echo "Usage: ./bench_mm.sh [all|buddy|mymalloc|tlsf] [operations] [--csv]"
+        exit 1
+        ;;
+esac
+
+HEADER=""
+for MANAGER in $MANAGERS; do
+    case "$MANAGER" in
+        buddy) SOURCE=../Kernel/mmu/buddy.c ;;
+        mymalloc) SOURCE=../Kernel/mmu/myMalloc.c ;;
+        tlsf) SOURCE=../Kernel/mmu/tlsf.c ;;
+    esac
+
+    gcc -O2 -o bench_mm bench_mm.c test_util.c kernel_stubs.c "$SOURCE" \
+        -I../Kernel/include -I. -Wall -Wno-builtin-declaration-mismatch -std=gnu99 || exit 1
+
+    ./bench_mm "$MANAGER" "$OPERATIONS" $FORMAT $HEADER
+    STATUS=$?
+    rm -f bench_mm
+    if [ $STATUS -ne 0 ]; then
+        exit $STATUS
+    fi
+    HEADER="--no-header"
+done
@@ -0,0 +1,99 @@
+// This is a personal academic project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+/*
+ * Host-side replacements for the few kernel symbols the allocators in
+ * Kernel/mmu/ depend on, so they can be linked into native test programs.
+ */
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <memoryManager.h>
+#include <frameAllocator.h>
+#include <memProfile.h>
+#include <memTrace.h>
+
+#ifndef HOST_MEMORY_SIZE
+#define HOST_MEMORY_SIZE (1u << 20)
+#endif
+
+/* Stands in for the RAM the kernel gets from the E820 map: one region */
+static uint8_t host_memory[HOST_MEMORY_SIZE] __attribute__((aligned(FRAME_SIZE)));
+static size_t host_memory_used = 0;
+
+/* Tracing is never turned on in host builds */
+volatile bool mem_trace_active = false;
+
+#ifdef HOST_PROFILER
+/* The real profiler is linked in; it only needs the tracer and the clock */
+void mem_trace_record(bool is_alloc, void *ptr, size_t size) {
+  (void)is_alloc;
+  (void)ptr;
+  (void)size;
+}
+
+int ticks_elapsed(void) {
+  return 0;
+}
+#else
+/* Neither is profiling, unless a test links memProfile.c with HOST_PROFILER */
+volatile bool mem_profile_active = false;
+
+void mem_profile_on_alloc(void *ptr, size_t size, void *caller) {
+  (void)ptr;
+  (void)size;
+  (void)caller;
+}
+
+void mem_profile_on_free(void *ptr) {
+  (void)ptr;
+}
+
+void mem_profile_inherit(void *ptr) {
+  (void)ptr;
+}
+
+void mem_profile_inherit_end(void) {
+}
+
+/* With profiling off the kernel's tagged allocations are plain ones too */
+void *mem_alloc_tagged(size_t size, mem_tag_t tag) {
+  (void)tag;
+  return mem_alloc(size);
+}
+
+void *mem_alloc_aligned_tagged(size_t size, size_t align, mem_tag_t tag) {
+  (void)tag;
+  return mem_alloc_aligned(size, align);
+}
+#endif
+
+void memzero(void *destination, uint64_t length) {
+  memset(destination, 0, length);
+}
+
+void _cli(void) {
+}
+
+void _sti(void) {
+}
+
+int32_t print_mem_status_common(const mem_stats_t *stats) {
+  printf("Total: %zu\nUsed:  %zu\nFree:  %zu\nLargest free: %zu\n",
+         stats->total, stats->used, stats->free, stats->largest_free);
+  return 0;
+}
+
+void *frames_alloc(size_t count) {
+  size_t size = count * FRAME_SIZE;
+  if (count == 0 || size > HOST_MEMORY_SIZE - host_memory_used) {
+    return NULL;
+  }
+  void *result = host_memory + host_memory_used;
+  host_memory_used += size;
+  return result;
+}
+
+size_t frames_largest_run(void) {
+  return (HOST_MEMORY_SIZE - host_memory_used) / FRAME_SIZE;
+}
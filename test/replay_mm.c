@@ -0,0 +1,275 @@
+// This is a personal academic project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+/*
+ * Replays an allocation trace captured with `memtrace dump` against one
+ * kernel allocator. Trace lines look like "A <tick> <pid> <size> <ptr>" or
+ * "F <tick> <pid> 0 <ptr>"; anything else (boot noise on the serial port,
+ * comments) is ignored. Frees are matched to their allocation before the
+ * replay starts, so the timed loop only calls mem_alloc/mem_free.
+ */
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+#include <memoryManager.h>
+
+#define LINE_MAX_LENGTH 128
+#define NO_BLOCK UINT32_MAX
+
+typedef struct {
+  uint32_t block;
+  uint32_t size;
+  uint8_t is_alloc;
+} replay_op_t;
+
+typedef struct {
+  uint64_t ptr;
+  uint32_t block;
+} map_entry_t;
+
+static replay_op_t *ops = NULL;
+static size_t op_count = 0;
+static size_t op_capacity = 0;
+static uint32_t block_count = 0;
+static uint64_t unmatched_frees = 0;
+
+static map_entry_t *live_map = NULL;
+static size_t map_mask = 0;
+
+static inline uint64_t cycles(void) {
+  uint32_t lo, hi;
+  __asm__ volatile("rdtsc" : "=a"(lo), "=d"(hi));
+  return ((uint64_t)hi << 32) | lo;
+}
+
+static double seconds_now(void) {
+  struct timeval now;
+  gettimeofday(&now, NULL);
+  return (double)now.tv_sec + (double)now.tv_usec / 1e6;
+}
+
+static size_t map_home(uint64_t ptr) {
+  return (size_t)((ptr * 0x9E3779B97F4A7C15ULL) >> 20) & map_mask;
+}
+
+static void map_resize(void) {
+  size_t old_size = live_map == NULL ? 0 : map_mask + 1;
+  map_entry_t *old = live_map;
+  size_t size = old_size == 0 ? 1024 : old_size * 2;
+
+  live_map = calloc(size, sizeof(map_entry_t));
+  if (live_map == NULL) {
+    fprintf(stderr, "replay_mm: out of host memory\n");
+    exit(1);
+  }
+  map_mask = size - 1;
+
+  for (size_t i = 0; i < old_size; i++) {
+    if (old[i].ptr != 0) {
+      size_t slot = map_home(old[i].ptr);
+      while (live_map[slot].ptr != 0) {
+        slot = (slot + 1) & map_mask;
+      }
+      live_map[slot] = old[i];
+    }
+  }
+  free(old);
+}
+
+static void map_put(uint64_t ptr, uint32_t block, size_t live) {
+  if (live_map == NULL || live * 2 >= map_mask + 1) {
+    map_resize();
+  }
+  size_t slot = map_home(ptr);
+  while (live_map[slot].ptr != 0 && live_map[slot].ptr != ptr) {
+    slot = (slot + 1) & map_mask;
+  }
+  live_map[slot].ptr = ptr;
+  live_map[slot].block = block;
+}
+
+static uint32_t map_take(uint64_t ptr) {
+  if (live_map == NULL) {
+    return NO_BLOCK;
+  }
+  size_t slot = map_home(ptr);
+  while (live_map[slot].ptr != ptr) {
+    if (live_map[slot].ptr == 0) {
+      return NO_BLOCK;
+    }
+    slot = (slot + 1) & map_mask;
+  }
+  uint32_t block = live_map[slot].block;
+
+  /* Backward-shift deletion */
+  size_t hole = slot;
+  size_t next = slot;
+  while (1) {
+    next = (next + 1) & map_mask;
+    if (live_map[next].ptr == 0) {
+      break;
+    }
+    size_t home = map_home(live_map[next].ptr);
+    int movable = hole <= next ? (home <= hole || home > next) : (home <= hole && home > next);
+    if (movable) {
+      live_map[hole] = live_map[next];
+      hole = next;
+    }
+  }
+  live_map[hole].ptr = 0;
+  return block;
+}
+
+static void push_op(uint32_t block, uint32_t size, uint8_t is_alloc) {
+  if (op_count == op_capacity) {
+    op_capacity = op_capacity == 0 ? 4096 : op_capacity * 2;
+    ops = realloc(ops, op_capacity * sizeof(replay_op_t));
+    if (ops == NULL) {
+      fprintf(stderr, "replay_mm: out of host memory\n");
+      exit(1);
+    }
+  }
+  ops[op_count].block = block;
+  ops[op_count].size = size;
+  ops[op_count].is_alloc = is_alloc;
+  op_count++;
+}
+
+static int load_trace(const char *path) {
+  FILE *file = fopen(path, "r");
+  if (file == NULL) {
+    perror(path);
+    return -1;
+  }
+
+  char line[LINE_MAX_LENGTH];
+  size_t live = 0;
+  while (fgets(line, sizeof(line), file) != NULL) {
+    char kind;
+    unsigned long tick, pid, size;
+    unsigned long long ptr;
+    if (sscanf(line, " %c %lu %lu %lu %llx", &kind, &tick, &pid, &size, &ptr) != 5 || ptr == 0) {
+      continue;
+    }
+
+    if (kind == 'A') {
+      /* An address handed out twice means its free predates the trace */
+      if (map_take(ptr) != NO_BLOCK) {
+        live--;
+      }
+      map_put(ptr, block_count, live++);
+      push_op(block_count++, (uint32_t)size, 1);
+    } else if (kind == 'F') {
+      uint32_t block = map_take(ptr);
+      if (block == NO_BLOCK) {
+        unmatched_frees++;
+        continue;
+      }
+      live--;
+      push_op(block, 0, 0);
+    }
+  }
+
+  fclose(file);
+  return 0;
+}
+
+/* External fragmentation: share of free memory outside the largest free block */
+static double fragmentation(void) {
+  mem_stats_t stats;
+  mem_get_stats(&stats);
+  if (stats.free == 0) {
+    return 0.0;
+  }
+  return 100.0 * (double)(stats.free - stats.largest_free) / (double)stats.free;
+}
+
+int main(int argc, char *argv[]) {
+  const char *allocator = "allocator";
+  const char *path = NULL;
+  int csv = 0;
+  int header = 1;
+
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--csv") == 0) {
+      csv = 1;
+    } else if (strcmp(argv[i], "--no-header") == 0) {
+      header = 0;
+    } else if (path == NULL) {
+      path = argv[i];
+    } else {
+      allocator = argv[i];
+    }
+  }
+
+  if (path == NULL) {
+    fprintf(stderr, "Usage: replay_mm <trace> [allocator] [--csv] [--no-header]\n");
+    return 1;
+  }
+  if (load_trace(path) < 0) {
+    return 1;
+  }
+
+  void **blocks = calloc(block_count + 1, sizeof(void *));
+  if (blocks == NULL) {
+    fprintf(stderr, "replay_mm: out of host memory\n");
+    return 1;
+  }
+
+  mem_init();
+  uint64_t failures = 0;
+  uint64_t timed = 0;
+  double peak_fragmentation = 0.0;
+  double start = seconds_now();
+  uint64_t start_cycles = cycles();
+
+  for (size_t i = 0; i < op_count; i++) {
+    replay_op_t *op = &ops[i];
+    uint64_t begin = cycles();
+    if (op->is_alloc) {
+      blocks[op->block] = mem_alloc(op->size);
+      timed += cycles() - begin;
+      if (blocks[op->block] == NULL) {
+        failures++;
+      }
+    } else {
+      mem_free(blocks[op->block]);
+      timed += cycles() - begin;
+      blocks[op->block] = NULL;
+    }
+
+    double current = fragmentation();
+    if (current > peak_fragmentation) {
+      peak_fragmentation = current;
+    }
+  }
+
+  double tsc_hz = (double)(cycles() - start_cycles) / (seconds_now() - start);
+  double seconds = (double)timed / tsc_hz;
+  mem_stats_t stats;
+  mem_get_stats(&stats);
+
+  if (header) {
+    if (csv) {
+      printf("allocator,operations,alloc_ms,ops_per_sec,peak_footprint,peak_frag_pct,failed,unmatched_frees\n");
+    } else {
+      printf("%-9s %10s %10s %12s %14s %9s %8s %10s\n", "allocator", "ops", "time ms", "ops/sec",
+             "peak bytes", "peak frag", "failed", "unmatched");
+    }
+  }
+  if (csv) {
+    printf("%s,%zu,%.3f,%.0f,%zu,%.1f,%llu,%llu\n", allocator, op_count, seconds * 1000.0,
+           seconds > 0.0 ? (double)op_count / seconds : 0.0, stats.peak_used, peak_fragmentation,
+           (unsigned long long)failures, (unsigned long long)unmatched_frees);
+  } else {
+    printf("%-9s %10zu %10.3f %12.0f %14zu %8.1f%% %8llu %10llu\n", allocator, op_count, seconds * 1000.0,
+           seconds > 0.0 ? (double)op_count / seconds : 0.0, stats.peak_used, peak_fragmentation,
+           (unsigned long long)failures, (unsigned long long)unmatched_frees);
+  }
+
+  free(blocks);
+  free(ops);
+  free(live_map);
+  return 0;
+}
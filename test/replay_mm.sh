@@ -0,0 +1,45 @@
+#!/bin/bash
+# Replays an allocation trace captured with `memtrace dump` against each
+# memory manager. The trace is the serial log of the kernel, e.g. from
+# ./run.sh -serial file:trace.txt; unrelated lines are skipped.
+# Usage: ./replay_mm.sh <trace> [all|buddy|mymalloc|tlsf] [--csv]
+# Time only counts mem_alloc/mem_free; footprint is the allocator's own peak.
+
+TRACE=$1
+MEMORY_MANAGER=${2:-all}
+FORMAT=$3
+
+if [ -z "$TRACE" ] || [ ! -f "$TRACE" ]; then
+    echo "Usage: ./replay_mm.sh <trace> [all|buddy|mymalloc|tlsf] [--csv]"
+    exit 1
+fi
+
+case "$MEMORY_MANAGER" in
+    all) MANAGERS="buddy mymalloc tlsf" ;;
+    buddy|mymalloc|tlsf) MANAGERS=$MEMORY_MANAGER ;;
+    *)
+        echo "Usage: ./replay_mm.sh <trace> [all|buddy|mymalloc|tlsf] [--csv]"
+        exit 1
+        ;;
+esac
+
+HEADER=""
+for MANAGER in $MANAGERS; do
+    case "$MANAGER" in
+        buddy) SOURCE=../Kernel/mmu/buddy.c ;;
+        mymalloc) SOURCE=../Kernel/mmu/myMalloc.c ;;
+        tlsf) SOURCE=../Kernel/mmu/tlsf.c ;;
+    esac
+
+    # Kernel traces can hold far more live memory than the 1 MiB test heap
+    gcc -O2 -o replay_mm replay_mm.c kernel_stubs.c "$SOURCE" -DHOST_MEMORY_SIZE='(64u << 20)' \
+        -I../Kernel/include -I. -Wall -Wno-builtin-declaration-mismatch -std=gnu99 || exit 1
+
+    ./replay_mm "$TRACE" "$MANAGER" $FORMAT $HEADER
+    STATUS=$?
+    rm -f replay_mm
+    if [ $STATUS -ne 0 ]; then
+        exit $STATUS
+    fi
+    HEADER="--no-header"
+done
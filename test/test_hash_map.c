@@ -0,0 +1,148 @@
+// This is a personal academic project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+#include <stdint.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <memoryManager.h>
+#include <hashMap.h>
+#include "test_util.h"
+
+/*
+ * Keys come from a small range so inserts, replacements and removals keep
+ * hitting the same probe chains while the table grows past several sizes.
+ */
+#define KEY_RANGE 1500
+#define KEY_NAME_MAX 8
+
+/* Reference model: the value stored under each key, 0 when absent */
+static uintptr_t model[KEY_RANGE];
+static uint32_t model_size = 0;
+static char key_names[KEY_RANGE][KEY_NAME_MAX];
+static uintptr_t next_value = 1;
+
+static uint32_t visited[KEY_RANGE];
+
+/* Integer keys share their low bits, as addresses used as futex keys do */
+static uint64_t int_key(uint32_t key) {
+  return 0x400000 + ((uint64_t)key << 12);
+}
+
+static const char *str_key(uint32_t key) {
+  return key_names[key];
+}
+
+static bool map_put(hash_map_t *map, bool strings, uint32_t key, void *value) {
+  return strings ? hash_map_put_str(map, str_key(key), value) : hash_map_put_int(map, int_key(key), value);
+}
+
+static void *map_get(hash_map_t *map, bool strings, uint32_t key) {
+  return strings ? hash_map_get_str(map, str_key(key)) : hash_map_get_int(map, int_key(key));
+}
+
+static void *map_remove(hash_map_t *map, bool strings, uint32_t key) {
+  return strings ? hash_map_remove_str(map, str_key(key)) : hash_map_remove_int(map, int_key(key));
+}
+
+/* Values encode their key in the low bits so visits can be attributed */
+static uint32_t key_of_value(uintptr_t value) {
+  return (uint32_t)(value % KEY_RANGE);
+}
+
+static bool visit(void *value, void *context) {
+  (void)context;
+  visited[key_of_value((uintptr_t)value)]++;
+  return true;
+}
+
+/* Every key is looked up, and for_each must visit each stored value once */
+static int check_map(hash_map_t *map, bool strings, uint64_t op) {
+  if (hash_map_size(map) != model_size) {
+    printf("test_hash_map ERROR at op %lu: size %zu, expected %u\n", (unsigned long)op, hash_map_size(map), model_size);
+    return -1;
+  }
+
+  for (uint32_t key = 0; key < KEY_RANGE; key++) {
+    visited[key] = 0;
+    if ((uintptr_t)map_get(map, strings, key) != model[key]) {
+      printf("test_hash_map ERROR at op %lu: key %u\n", (unsigned long)op, key);
+      return -1;
+    }
+  }
+
+  hash_map_for_each(map, visit, NULL);
+  for (uint32_t key = 0; key < KEY_RANGE; key++) {
+    if (visited[key] != (model[key] != 0 ? 1u : 0u)) {
+      printf("test_hash_map ERROR at op %lu: key %u visited %u times\n", (unsigned long)op, key, visited[key]);
+      return -1;
+    }
+  }
+  return 0;
+}
+
+static int test_hash_map(bool strings, uint64_t operations) {
+  hash_map_t *map = strings ? hash_map_create_str(MEM_TAG_KERNEL) : hash_map_create_int(MEM_TAG_KERNEL);
+  if (map == NULL) {
+    printf("test_hash_map ERROR: create failed\n");
+    return -1;
+  }
+  for (uint32_t key = 0; key < KEY_RANGE; key++)
+    model[key] = 0;
+  model_size = 0;
+
+  for (uint64_t op = 0; op < operations; op++) {
+    uint32_t key = GetUniform(KEY_RANGE);
+    uint32_t action = GetUniform(100);
+
+    /* Alternate between filling the table up and emptying it */
+    uint32_t put_share = (op / 20000) % 2 == 0 ? 60 : 25;
+    if (action < put_share) {
+      uintptr_t value = next_value++ * KEY_RANGE + key;
+      if (!map_put(map, strings, key, (void *)value)) {
+        printf("test_hash_map ERROR at op %lu: put failed\n", (unsigned long)op);
+        return -1;
+      }
+      if (model[key] == 0)
+        model_size++;
+      model[key] = value;
+    } else if (action < 90) {
+      uintptr_t value = (uintptr_t)map_remove(map, strings, key);
+      if (value != model[key]) {
+        printf("test_hash_map ERROR at op %lu: removing key %u returned %lu\n", (unsigned long)op, key, (unsigned long)value);
+        return -1;
+      }
+      if (model[key] != 0)
+        model_size--;
+      model[key] = 0;
+    } else if ((uintptr_t)map_get(map, strings, key) != model[key]) {
+      printf("test_hash_map ERROR at op %lu: key %u\n", (unsigned long)op, key);
+      return -1;
+    }
+
+    /* A full check walks every key, so it only runs every so often */
+    if (op % 97 == 0 && check_map(map, strings, op) < 0)
+      return -1;
+  }
+
+  if (check_map(map, strings, operations) < 0)
+    return -1;
+  hash_map_destroy(map);
+  return 0;
+}
+
+int main(int argc, char *argv[]) {
+  uint64_t operations = 400000;
+
+  if (argc == 2) {
+    operations = satoi(argv[1]);
+  }
+
+  for (uint32_t key = 0; key < KEY_RANGE; key++)
+    snprintf(key_names[key], KEY_NAME_MAX, "k%u", key);
+
+  mem_init();
+  if (test_hash_map(false, operations) < 0 || test_hash_map(true, operations) < 0)
+    return 1;
+
+  printf("%lu integer and %lu string key operations matched the reference model\n", (unsigned long)operations, (unsigned long)operations);
+  return 0;
+}
@@ -0,0 +1,26 @@
+#!/bin/bash
+# Checks the hash map against a reference model with random inserts,
+# replacements, removals and lookups, for integer and string keys.
+# Usage: ./test_hash_map.sh [operations]
+
+RED='\033[0;31m'
+GREEN='\033[0;32m'
+NC='\033[0m' # No Color
+
+OPERATIONS=${1:-400000}
+
+# The map allocates through the kernel heap, here the buddy allocator
+gcc -o test_hash_map test_hash_map.c test_util.c kernel_stubs.c \
+    ../Kernel/collections/hashMap.c ../Kernel/mmu/buddy.c \
+    -I../Kernel/include -I. -Wall -Wextra -Wno-builtin-declaration-mismatch -std=c99 || exit 1
+
+./test_hash_map "$OPERATIONS"
+TEST_RESULT=$?
+rm -f test_hash_map
+
+if [ $TEST_RESULT -eq 0 ]; then
+    echo -e "${GREEN}✓ Hash map passed${NC}"
+else
+    echo -e "${RED}✗ Hash map failed${NC}"
+fi
+exit $TEST_RESULT
@@ -12,11 +12,16 @@ echo "================================"
 # Check which memory manager to test (default: buddy)
 MEMORY_MANAGER=${1:-buddy}
 
-if [ "$MEMORY_MANAGER" != "buddy" ] && [ "$MEMORY_MANAGER" != "mymalloc" ]; then
-    echo -e "${RED}Error: Invalid memory manager. Use 'buddy' or 'mymalloc'${NC}"
-    echo "Usage: ./test_memory.sh [buddy|mymalloc] [max_memory]"
-    exit 1
-fi
+case "$MEMORY_MANAGER" in
+    buddy) SOURCE=../Kernel/mmu/buddy.c ;;
+    mymalloc) SOURCE=../Kernel/mmu/myMalloc.c ;;
+    tlsf) SOURCE=../Kernel/mmu/tlsf.c ;;
+    *)
+        echo -e "${RED}Error: Invalid memory manager. Use 'buddy', 'mymalloc' or 'tlsf'${NC}"
+        echo "Usage: ./test_memory.sh [buddy|mymalloc|tlsf] [max_memory]"
+        exit 1
+        ;;
+esac
 
 echo -e "Testing memory manager: ${GREEN}${MEMORY_MANAGER}${NC}\n"
 
@@ -26,15 +31,9 @@ MAX_MEMORY=${2:-50000}
 # Compile the memory manager and test
 echo "Compiling..."
 
-if [ "$MEMORY_MANAGER" = "buddy" ]; then
-    gcc -o test_mm test_mm.c test_util.c ../Kernel/memory/buddy.c \
-        -I../Kernel/include -I. \
-        -Wall -Wextra -std=c99
-else
-    gcc -o test_mm test_mm.c test_util.c ../Kernel/memory/myMalloc.c \
-        -I../Kernel/include -I. \
-        -Wall -Wextra -std=c99
-fi
+gcc -o test_mm test_mm.c test_util.c kernel_stubs.c "$SOURCE" \
+    -I../Kernel/include -I. \
+    -Wall -Wextra -Wno-builtin-declaration-mismatch -std=c99
 
 if [ $? -ne 0 ]; then
     echo -e "${RED}Compilation failed!${NC}"
@@ -0,0 +1,83 @@
+// This is a personal academic project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+#include <stdint.h>
+#include <stdio.h>
+#include <memoryManager.h>
+#include <memProfile.h>
+#include "test_util.h"
+
+/* Sizes the block goes through: shrinks that stay put and growths that move */
+static const uint32_t sizes[] = { 100, 60, 3000, 40000, 200, 90000, 16 };
+
+static mem_profile_info_t info;
+
+/*
+ * The block must stay charged to MEM_TAG_USER with exactly its current size,
+ * and the blocker to MEM_TAG_SCHEDULER, whichever way the resize went.
+ */
+static int check_tags(uint32_t size, uint32_t blocker_size, uint32_t sites) {
+  mem_profile_snapshot(&info);
+  if (info.tags[MEM_TAG_USER].live_bytes != size || info.tags[MEM_TAG_USER].live_blocks != 1) {
+    printf("test_memprof ERROR: user tag has %lu bytes in %lu blocks, expected %u in 1\n",
+           (unsigned long)info.tags[MEM_TAG_USER].live_bytes, (unsigned long)info.tags[MEM_TAG_USER].live_blocks, size);
+    return -1;
+  }
+  if (info.tags[MEM_TAG_SCHEDULER].live_bytes != blocker_size) {
+    printf("test_memprof ERROR: scheduler tag has %lu bytes, expected %u\n",
+           (unsigned long)info.tags[MEM_TAG_SCHEDULER].live_bytes, blocker_size);
+    return -1;
+  }
+  if (info.tags[MEM_TAG_KERNEL].live_bytes != 0) {
+    printf("test_memprof ERROR: %lu bytes moved to the kernel tag\n", (unsigned long)info.tags[MEM_TAG_KERNEL].live_bytes);
+    return -1;
+  }
+  if (info.site_count != sites) {
+    printf("test_memprof ERROR: %u call sites, expected %u\n", info.site_count, sites);
+    return -1;
+  }
+  return 0;
+}
+
+static int test_memprof(void) {
+  if (mem_profile_control(MEM_PROFILE_ON) < 0) {
+    printf("test_memprof ERROR: profiling could not be turned on\n");
+    return -1;
+  }
+
+  void *block = mem_alloc_tagged(sizes[0], MEM_TAG_USER);
+  /* Sits right after the block so growing it has to move it */
+  void *blocker = mem_alloc_tagged(64, MEM_TAG_SCHEDULER);
+  if (block == NULL || blocker == NULL || check_tags(sizes[0], 64, 2) < 0)
+    return -1;
+
+  for (uint32_t i = 1; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+    void *resized = mem_realloc(block, sizes[i]);
+    if (resized == NULL) {
+      printf("test_memprof ERROR: realloc to %u bytes failed\n", sizes[i]);
+      return -1;
+    }
+    block = resized;
+    if (check_tags(sizes[i], 64, 2) < 0)
+      return -1;
+  }
+
+  mem_free(block);
+  mem_free(blocker);
+  mem_profile_snapshot(&info);
+  if (info.live_bytes != 0) {
+    printf("test_memprof ERROR: %lu bytes still live\n", (unsigned long)info.live_bytes);
+    return -1;
+  }
+  return 0;
+}
+
+int main(void) {
+  /* Taken before the heap, as the kernel does at boot */
+  mem_profile_init();
+  mem_init();
+  if (test_memprof() < 0)
+    return 1;
+
+  printf("Tags and call sites survived every realloc\n");
+  return 0;
+}
@@ -0,0 +1,40 @@
+#!/bin/bash
+# Checks that the allocation profiler keeps a block's tag and call site
+# across mem_realloc, in place or moved, on each memory manager.
+# Usage: ./test_memprof.sh [all|buddy|mymalloc|tlsf]
+
+RED='\033[0;31m'
+GREEN='\033[0;32m'
+NC='\033[0m' # No Color
+
+MEMORY_MANAGER=${1:-all}
+
+case "$MEMORY_MANAGER" in
+    all) MANAGERS="buddy mymalloc tlsf" ;;
+    buddy|mymalloc|tlsf) MANAGERS=$MEMORY_MANAGER ;;
+    *)
+        echo "Usage: ./test_memprof.sh [all|buddy|mymalloc|tlsf]"
+        exit 1
+        ;;
+esac
+
+for MANAGER in $MANAGERS; do
+    case "$MANAGER" in
+        buddy) SOURCE=../Kernel/mmu/buddy.c ;;
+        mymalloc) SOURCE=../Kernel/mmu/myMalloc.c ;;
+        tlsf) SOURCE=../Kernel/mmu/tlsf.c ;;
+    esac
+
+    gcc -o test_memprof test_memprof.c test_util.c kernel_stubs.c ../Kernel/mmu/memProfile.c "$SOURCE" \
+        -DHOST_PROFILER -I../Kernel/include -I. -Wall -Wextra -Wno-builtin-declaration-mismatch -std=c99 || exit 1
+
+    ./test_memprof
+    TEST_RESULT=$?
+    rm -f test_memprof
+
+    if [ $TEST_RESULT -ne 0 ]; then
+        echo -e "${RED}✗ ${MANAGER} failed${NC}"
+        exit $TEST_RESULT
+    fi
+    echo -e "${GREEN}✓ ${MANAGER} passed${NC}"
+done
@@ -7,12 +7,82 @@
 #include "test_util.h"
 
 #define MAX_BLOCKS 128
+/* Aligned requests use boundaries from 1 byte up to 2^MAX_ALIGN_SHIFT */
+#define MAX_ALIGN_SHIFT 12
 
 typedef struct MM_rq {
   void *address;
   uint32_t size;
 } mm_rq;
 
+/*
+ * Every third request is plain, aligned or zeroed, each checked as soon as
+ * it is made. Returns -1 when a block breaks its promise; running out of
+ * memory only leaves *address NULL.
+ */
+static int test_alloc(uint8_t rq, uint32_t size, void **address) {
+  if (rq % 3 == 1) {
+    size_t align = (size_t)1 << GetUniform(MAX_ALIGN_SHIFT + 1);
+    *address = mem_alloc_aligned(size, align);
+    if (*address != NULL && ((uintptr_t)*address & (align - 1)) != 0) {
+      printf("test_mm ERROR: %p is not aligned to %zu\n", *address, align);
+      return -1;
+    }
+    return 0;
+  }
+
+  if (rq % 3 == 2) {
+    /* Dirty the memory first so a zeroed block that reuses it must clear it */
+    *address = mem_alloc(size);
+    if (*address != NULL) {
+      memset(*address, 0xA5, size);
+      mem_free(*address);
+    }
+    *address = mem_alloc_zeroed(size);
+    if (*address != NULL && !memcheck(*address, 0, size)) {
+      printf("test_mm ERROR: block of %u bytes is not zeroed\n", size);
+      return -1;
+    }
+    return 0;
+  }
+
+  *address = mem_alloc(size);
+  return 0;
+}
+
+/*
+ * Grows even blocks and shrinks odd ones to a random size. Whatever fits in
+ * the new size must survive, in place or moved, and a failed resize must
+ * leave the block alone; then every block is checked again in case one
+ * spilled into a neighbour.
+ */
+static int test_realloc(mm_rq *mm_rqs, uint8_t rq) {
+  uint32_t i;
+  for (i = 0; i < rq; i++) {
+    uint32_t size = mm_rqs[i].size;
+    uint32_t new_size = i % 2 == 0 ? size + GetUniform(size) + 1 : GetUniform(size) + 1;
+    void *address = mem_realloc(mm_rqs[i].address, new_size);
+    if (address == NULL)
+      continue;
+
+    uint32_t kept = new_size < size ? new_size : size;
+    if (!memcheck(address, i, kept)) {
+      printf("test_mm ERROR: realloc from %u to %u bytes lost data\n", size, new_size);
+      return -1;
+    }
+    memset(address, i, new_size);
+    mm_rqs[i].address = address;
+    mm_rqs[i].size = new_size;
+  }
+
+  for (i = 0; i < rq; i++)
+    if (!memcheck(mm_rqs[i].address, i, mm_rqs[i].size)) {
+      printf("test_mm ERROR: block %u changed after realloc\n", i);
+      return -1;
+    }
+  return 0;
+}
+
 uint64_t test_mm(uint64_t max_memory) {
   mm_rq mm_rqs[MAX_BLOCKS];
   uint8_t rq;
@@ -24,7 +94,8 @@ uint64_t test_mm(uint64_t max_memory) {
 
     while (rq < MAX_BLOCKS && total < max_memory) {
       mm_rqs[rq].size = GetUniform(max_memory - total - 1) + 1;
-      mm_rqs[rq].address = mem_alloc(mm_rqs[rq].size);
+      if (test_alloc(rq, mm_rqs[rq].size, &mm_rqs[rq].address) < 0)
+        return -1;
 
       if (mm_rqs[rq].address) {
         total += mm_rqs[rq].size;
@@ -44,6 +115,9 @@ uint64_t test_mm(uint64_t max_memory) {
           return -1;
         }
 
+    if (test_realloc(mm_rqs, rq) < 0)
+      return -1;
+
     for (i = 0; i < rq; i++)
       if (mm_rqs[i].address)
         mem_free(mm_rqs[i].address);
@@ -58,7 +132,5 @@ int main(int argc, char *argv[]) {
   }
 
   mem_init();
-  test_mm(max_memory);
-  
-  return 0;
+  return test_mm(max_memory) == 0 ? 0 : 1;
 }
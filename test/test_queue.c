@@ -0,0 +1,127 @@
+// This is a personal academic project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+#include <stdint.h>
+#include <stdio.h>
+#include <memoryManager.h>
+#include <queueADT.h>
+#include "test_util.h"
+
+/* Enough to make the ring grow several times and wrap at every capacity */
+#define MAX_ELEMENTS 600
+
+/*
+ * Reference model: a plain array holding the queue in order. Elements are
+ * distinct non-NULL values so queue_remove always names a single one.
+ */
+static uintptr_t model[MAX_ELEMENTS];
+static uint32_t model_size = 0;
+static uintptr_t next_value = 1;
+
+static int model_find(uintptr_t value) {
+  for (uint32_t i = 0; i < model_size; i++)
+    if (model[i] == value)
+      return (int)i;
+  return -1;
+}
+
+static void model_remove_at(uint32_t index) {
+  for (uint32_t i = index; i + 1 < model_size; i++)
+    model[i] = model[i + 1];
+  model_size--;
+}
+
+/* Walks the queue with its iterator and compares it against the model */
+static int check_queue(const queue_t *queue, uint64_t op) {
+  if (queue_size(queue) != model_size || queue_is_empty(queue) != (model_size == 0)) {
+    printf("test_queue ERROR at op %lu: size %zu, expected %u\n", (unsigned long)op, queue_size(queue), model_size);
+    return -1;
+  }
+
+  queue_iterator_t iterator = queue_iter(queue);
+  uint32_t i = 0;
+  while (queue_iter_has_next(&iterator)) {
+    uintptr_t value = (uintptr_t)queue_iter_next(&iterator);
+    if (i >= model_size || value != model[i]) {
+      printf("test_queue ERROR at op %lu: element %u is %lu\n", (unsigned long)op, i, (unsigned long)value);
+      return -1;
+    }
+    i++;
+  }
+  if (i != model_size) {
+    printf("test_queue ERROR at op %lu: iterator stopped after %u of %u\n", (unsigned long)op, i, model_size);
+    return -1;
+  }
+  return 0;
+}
+
+static int test_queue(uint64_t operations) {
+  queue_t *queue = queue_create();
+  if (queue == NULL) {
+    printf("test_queue ERROR: queue_create failed\n");
+    return -1;
+  }
+
+  for (uint64_t op = 0; op < operations; op++) {
+    uint32_t action = GetUniform(100);
+
+    /* Drift between filling up and draining so every capacity gets wrapped */
+    uint32_t push_share = (op / 5000) % 2 == 0 ? 55 : 35;
+    if (action < push_share && model_size < MAX_ELEMENTS) {
+      uintptr_t value = next_value++;
+      if (!queue_push(queue, (void *)value)) {
+        printf("test_queue ERROR at op %lu: push failed\n", (unsigned long)op);
+        return -1;
+      }
+      model[model_size++] = value;
+    } else if (action < 75) {
+      uintptr_t value = (uintptr_t)queue_pop(queue);
+      uintptr_t expected = model_size > 0 ? model[0] : 0;
+      if (value != expected) {
+        printf("test_queue ERROR at op %lu: popped %lu, expected %lu\n", (unsigned long)op, (unsigned long)value, (unsigned long)expected);
+        return -1;
+      }
+      if (model_size > 0)
+        model_remove_at(0);
+    } else if (action < 97) {
+      /* Mostly present elements, anywhere in the queue; sometimes a missing one */
+      uintptr_t value = model_size > 0 && action < 94 ? model[GetUniform(model_size)] : next_value + 1;
+      int index = model_find(value);
+      if (queue_remove(queue, (void *)value) != (index >= 0)) {
+        printf("test_queue ERROR at op %lu: remove of %lu\n", (unsigned long)op, (unsigned long)value);
+        return -1;
+      }
+      if (index >= 0)
+        model_remove_at((uint32_t)index);
+    } else if (action < 99) {
+      uintptr_t expected = model_size > 0 ? model[0] : 0;
+      if ((uintptr_t)queue_peek(queue) != expected) {
+        printf("test_queue ERROR at op %lu: peek\n", (unsigned long)op);
+        return -1;
+      }
+    } else if (GetUniform(20) == 0) {
+      queue_clear(queue, NULL);
+      model_size = 0;
+    }
+
+    if (check_queue(queue, op) < 0)
+      return -1;
+  }
+
+  queue_destroy(queue, NULL);
+  return 0;
+}
+
+int main(int argc, char *argv[]) {
+  uint64_t operations = 400000;
+
+  if (argc == 2) {
+    operations = satoi(argv[1]);
+  }
+
+  mem_init();
+  if (test_queue(operations) < 0)
+    return 1;
+
+  printf("%lu operations matched the reference model\n", (unsigned long)operations);
+  return 0;
+}
@@ -0,0 +1,36 @@
+#!/bin/bash
+# Checks a queue implementation against a reference model with random
+# push, pop, remove, peek and clear operations.
+# Usage: ./test_queue.sh [ring|list] [operations]
+
+RED='\033[0;31m'
+GREEN='\033[0;32m'
+NC='\033[0m' # No Color
+
+QUEUE_IMPL=${1:-ring}
+OPERATIONS=${2:-400000}
+
+case "$QUEUE_IMPL" in
+    ring) SOURCE=../Kernel/collections/queueRing.c ;;
+    list) SOURCE=../Kernel/collections/queueADT.c ;;
+    *)
+        echo "Usage: ./test_queue.sh [ring|list] [operations]"
+        exit 1
+        ;;
+esac
+
+# The queues allocate through the kernel heap, here the buddy allocator
+gcc -o test_queue test_queue.c test_util.c kernel_stubs.c "$SOURCE" \
+    ../Kernel/mmu/buddy.c ../Kernel/mmu/slab.c \
+    -I../Kernel/include -I. -Wall -Wextra -Wno-builtin-declaration-mismatch -std=c99 || exit 1
+
+./test_queue "$OPERATIONS"
+TEST_RESULT=$?
+rm -f test_queue
+
+if [ $TEST_RESULT -eq 0 ]; then
+    echo -e "${GREEN}✓ ${QUEUE_IMPL} queue passed${NC}"
+else
+    echo -e "${RED}✗ ${QUEUE_IMPL} queue failed${NC}"
+fi
+exit $TEST_RESULT